@@ -5,16 +5,47 @@
  * See the README.md for further information.
  */
 
+/* Make the POSIX.1-2008 functions such as nanosleep() visible even in
+ * a strict ISO C build; this must come before any header */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE) && \
+    !defined(_XOPEN_SOURCE) && !defined(_GNU_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #define AKS_TRANSLATE_MAIN
 #include "aksmacro.h"
 
 #include "aksview.h"
+#include "libbinpoke.h"
 
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef AKS_WIN
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#ifdef BINPOKE_GZIP
+#include <zlib.h>
+#endif
+
+#ifdef BINPOKE_INOTIFY
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+#ifdef BINPOKE_THREADS
+#include <pthread.h>
+#endif
+
 /* On Windows, make sure we are building in Unicode */
 #ifdef AKS_WIN
 #ifndef AKS_WIN_WAPI
@@ -23,6 +54,45 @@
 #ifndef AKS_WIN_WCRT
 #error binpoke: UNICODE and _UNICODE must be defined for Windows builds!
 #endif
+#ifdef BINPOKE_FADVISE
+#error binpoke: BINPOKE_FADVISE is not supported on Windows!
+#endif
+#ifdef BINPOKE_LOCK
+#error binpoke: BINPOKE_LOCK is not supported on Windows!
+#endif
+#ifdef BINPOKE_SPARSE
+#error binpoke: BINPOKE_SPARSE is not supported on Windows!
+#endif
+#ifdef BINPOKE_INOTIFY
+#error binpoke: BINPOKE_INOTIFY is not supported on Windows!
+#endif
+#ifdef BINPOKE_FALLOCATE
+#error binpoke: BINPOKE_FALLOCATE is not supported on Windows!
+#endif
+#ifdef BINPOKE_THREADS
+#error binpoke: BINPOKE_THREADS is not supported on Windows!
+#endif
+#endif
+
+/* Byte-range locking needs open file description locks */
+#ifdef BINPOKE_LOCK
+#ifndef F_OFD_SETLK
+#error binpoke: BINPOKE_LOCK requires F_OFD_SETLK (define _GNU_SOURCE)!
+#endif
+#endif
+
+/* Shifting ranges needs the Linux extensions of fallocate() */
+#ifdef BINPOKE_FALLOCATE
+#ifndef FALLOC_FL_INSERT_RANGE
+#error binpoke: BINPOKE_FALLOCATE requires FALLOC_FL_* (define _GNU_SOURCE)!
+#endif
+#endif
+
+/* Hole detection needs the SEEK_DATA extension of lseek() */
+#ifdef BINPOKE_SPARSE
+#ifndef SEEK_DATA
+#error binpoke: BINPOKE_SPARSE requires SEEK_DATA (define _GNU_SOURCE)!
+#endif
 #endif
 
 /*
@@ -38,506 +108,10829 @@
 #define LIST_MAXBYTES (INT64_C(65536))
 
 /*
- * Type declarations
- * =================
+ * The size in bytes of the buffer used for streaming through large
+ * ranges of a file.
+ * 
+ * This must be a multiple of eight, so that a block always holds a
+ * whole number of integers of any width.
  */
+#define BLOCK_SIZE (65536)
 
 /*
- * Structure that stores a single line of data for a listing.
+ * The alignment in bytes of the buffer pool and of each buffer carved
+ * from it.  It is set here to 4K, which is the page size of most
+ * platforms.
  */
-typedef struct {
-  
-  /*
-   * The paragraph number to display.
-   * 
-   * This is the 32 least significant bytes of the address, divided by
-   * 16.
-   */
-  int32_t para;
-  
-  /*
-   * The unsigned byte values to display.
-   * 
-   * This array has one element for each byte of the paragraph.
-   * 
-   * Elements that are present must be in range [0, 255].
-   * 
-   * You can also use negative values for elements that are not present,
-   * such as occurs if you have a partial line that goes outside the
-   * boundaries of the range being listed.
-   */
-  int bv[16];
-  
-} LIST_LINE;
+#define POOL_ALIGN (INT64_C(4096))
 
 /*
- * Local data
- * ==========
+ * The maximum number of buffers that may be taken from the buffer pool
+ * at the same time.
  */
+#define POOL_MAXBUF (32)
 
 /*
- * The executable module name, used in diagnostic messages.
+ * The smallest memory budget that may be given, which is set here to
+ * 64K.
+ */
+#define POOL_MINCAP (INT64_C(65536))
+
+/*
+ * Flags that may be combined in the listing mode.
  * 
- * Set at the start of the program entrypoint.
+ * LIST_MODE_COLLAPSE replaces runs of repeated paragraphs in a listing
+ * with a single "*" marker line, in the same manner as hexdump.
+ * 
+ * LIST_MODE_FOLLOW keeps watching the file after the listing, and lists
+ * any bytes that are appended to it.
+ * 
+ * LIST_MODE_SESSION lists the file as seen through its open edit
+ * session.
+ * 
+ * LIST_MODE_GZIP lists the uncompressed contents of a gzip file.
  */
-const char *pModule = NULL;
+#define LIST_MODE_COLLAPSE (1)
+#define LIST_MODE_FOLLOW   (2)
+#define LIST_MODE_SESSION  (4)
+#define LIST_MODE_GZIP     (8)
 
 /*
- * Local functions
- * ===============
+ * The minimum and maximum delay in milliseconds between checks for
+ * growth of a followed file.
+ * 
+ * The delay starts at the minimum and doubles each time a check finds
+ * no new data, up to the maximum.  It drops back to the minimum as soon
+ * as new data arrives.
  */
+#define FOLLOW_MINDELAY (10)
+#define FOLLOW_MAXDELAY (1000)
 
-/* Prototypes */
-static void fault(int line);
-static void printInt64(int64_t v);
-static void printListLine(const LIST_LINE *pl);
+/*
+ * Flags that may be combined in the batch mode.
+ * 
+ * BATCH_MODE_JOURNAL records the before-image of every byte range that
+ * the batch will overwrite into an undo journal before any data is
+ * modified, so that an interrupted batch can be rolled back with the
+ * recover verb.
+ */
+#define BATCH_MODE_JOURNAL (1)
 
-static int64_t parseCount(const char *pstr);
-static int parseHex(const char *pstr, uint64_t *pv);
-static int64_t parseAddress(const char *pstr);
+/*
+ * Flags that may be combined in the query mode.
+ * 
+ * QUERY_MODE_LIST treats the path given to the query verb as a text
+ * file listing the paths of the files to query, one per line.
+ * 
+ * QUERY_MODE_GZIP reports the uncompressed length of a gzip file.
+ */
+#define QUERY_MODE_LIST (1)
+#define QUERY_MODE_GZIP (2)
 
-static int verb_list(
-    const char *pPath,
-    const char *pFrom,
-    const char *pFor);
+/*
+ * Flags that may be combined in the editing mode of the read, write,
+ * resize, insert, and remove verbs.
+ * 
+ * EDIT_MODE_SESSION operates on the file as seen through its open edit
+ * session, recording any changes in the session rather than the file.
+ * 
+ * EDIT_MODE_GZIP operates on the uncompressed contents of a gzip file.
+ * It is only accepted by the read verb.
+ */
+#define EDIT_MODE_SESSION (1)
+#define EDIT_MODE_GZIP    (2)
 
-static int verb_read(
-    const char *pPath,
-    const char *pAt,
-    const char *pAs);
+/*
+ * The maximum length in characters of a single token within a batch
+ * script, excluding the terminating nul.
+ */
+#define BATCH_MAXTOKEN (63)
 
-static int verb_write(
-    const char *pPath,
-    const char *pAt,
-    const char *pAs,
-    const char *pWith);
+/*
+ * Flag shared by the modes of the verbs that stream through large
+ * ranges, which is chosen not to collide with any verb-specific flag.
+ * 
+ * SCAN_MODE_NOCACHE drops the cached pages of the file behind the scan,
+ * so that one large scan does not evict everything else from the page
+ * cache.
+ */
+#define SCAN_MODE_NOCACHE (256)
 
-static int verb_query(const char *pPath);
-static int verb_resize(const char *pPath, const char *pWith);
-static int verb_require(const char *pPath);
-static int verb_new(const char *pPath);
+/*
+ * Flag shared by the modes of the verbs that lock byte ranges, which is
+ * chosen not to collide with any verb-specific flag.
+ * 
+ * LOCK_MODE_WAIT waits until locked byte ranges are free, instead of
+ * failing straight away.
+ */
+#define LOCK_MODE_WAIT (512)
 
 /*
- * Invoked when there is an unexpected error condition.
+ * Special length that locks a byte range from a given offset through to
+ * the end of the file, including any bytes later appended.
+ */
+#define LOCK_TO_END (-1)
+
+/*
+ * The number of bytes a scan goes through between requests to drop the
+ * cached pages behind it.  It is set here to 8M.
+ */
+#define CACHE_SPAN (INT64_C(8388608))
+
+/*
+ * Flags that may be combined in the transform mode.
  * 
- * Prints a diagnostic message to stderr and then exits program with
- * failure code.
+ * XFORM_MODE_AND combines each byte with the key using bitwise AND,
+ * XFORM_MODE_OR using bitwise OR, and XFORM_MODE_XOR using bitwise XOR.
+ * At most one of them may be set, and if none is set, bitwise XOR is
+ * used.
+ */
+#define XFORM_MODE_AND (1)
+#define XFORM_MODE_OR  (2)
+#define XFORM_MODE_XOR (4)
+
+/*
+ * The maximum length in bytes of a transform key.
+ */
+#define XFORM_MAXKEY (256)
+
+/*
+ * Flags that may be combined in the walk mode.
  * 
- * Parameters:
+ * WALK_MODE_INDEX writes the chunk table to the chunk index instead of
+ * printing it.
+ */
+#define WALK_MODE_INDEX (1)
+
+/*
+ * The maximum header size of a chunk, the maximum alignment of chunks,
+ * and the maximum length in characters of a single item of a chunk
+ * layout, excluding the terminating nul.
+ */
+#define CHUNK_MAXHEAD  (256)
+#define CHUNK_MAXALIGN (INT64_C(65536))
+#define CHUNK_MAXITEM  (63)
+
+/*
+ * The default and the largest minimum length in bytes of a run of
+ * printable characters found by the strings verb.
+ */
+#define STRINGS_MINLEN (4)
+#define STRINGS_MAXMIN (1024)
+
+/*
+ * Flags that may be combined in the changed mode.
  * 
- *   line - the line number of the fault in this source file
+ * CHANGED_MODE_FULL hashes every block, even when the modification time
+ * of the file shows that it has not changed since the block manifest
+ * was written.
  * 
- * Return:
+ * CHANGED_MODE_UPDATE brings the block manifest up to date with the
+ * file.
+ */
+#define CHANGED_MODE_FULL   (1)
+#define CHANGED_MODE_UPDATE (2)
+
+/*
+ * The default and the largest block size of a block manifest, which are
+ * set here to 1M and 1G.  Block sizes must be a multiple of BLOCK_SIZE.
+ */
+#define MANIFEST_BLOCK    (INT64_C(1048576))
+#define MANIFEST_MAXBLOCK (INT64_C(1073741824))
+
+/*
+ * The number of seconds by which the modification time of a file must
+ * be older than the current time for it to be recorded in a block
+ * manifest.
  * 
- *   this function never returns
+ * Modification times only have a resolution of one second, or two
+ * seconds on some file systems, so a file that was modified more
+ * recently than this could be modified again without its time
+ * changing.
  */
-static void fault(int line) {
-  fprintf(stderr, "Fault in binpoke at line %d\n", line);
-  exit(EXIT_FAILURE);
-}
+#define MANIFEST_SLACK (2)
 
 /*
- * Print a signed 64-bit integer value in decimal to standard output.
+ * The largest number of workers that the changed verb uses to hash
+ * blocks in parallel, and the number of consecutive blocks that each
+ * worker hashes in one round.
  * 
- * Parameters:
+ * Only one worker is used unless compiled with BINPOKE_THREADS.
+ */
+#define HASH_MAXWORKERS (8)
+#define HASH_ROUND      (4)
+
+/*
+ * The unit in bytes in which the mirror verb compares and writes each
+ * block.  It is set here to 4K, which is the page size of most
+ * platforms, so that only pages that differ are dirtied.
+ */
+#define MIRROR_PAGE (INT32_C(4096))
+
+/*
+ * The primes of the block hash, which are those of xxHash64.
+ */
+#define HASH_PRIME1 (UINT64_C(0x9e3779b185ebca87))
+#define HASH_PRIME2 (UINT64_C(0xc2b2ae3d27d4eb4f))
+#define HASH_PRIME3 (UINT64_C(0x165667b19e3779f9))
+
+/*
+ * The maximum length in characters of a single line of a listing read
+ * by the import verb, excluding the line break.
  * 
- *   v - the integer value to print
+ * This only limits plain hex data that is not broken into lines.  It is
+ * set here to 1M.
  */
-static void printInt64(int64_t v) {
-  
-  /* Handle the different cases */
-  if (v <= INT64_MIN) {
-    /* Special case of the least negative value -- this integer value
-     * has no positive equivalent due to the way two's complement works,
-     * so just print its value as a special case */
-    printf("-9223372036854775808");
-    
-  } else if ((v > INT64_MIN) && (v < 0)) {
-    /* If we have a negative value besides the least negative value that
-     * we just handled as a special case, print a negative sign and then
-     * recursively print the positive value */
-    putchar('-');
-    printInt64(0 - v);
-    
-  } else if (v >= 10) {
-    /* If value is positive and has more than one digit, first
-     * recursively print the value except for the last digit */
-    printInt64(v / 10);
-    
-    /* Finally, print the last digit */
-    putchar(((int) (v % 10)) + '0');
-    
-  } else if ((v >= 0) && (v < 10)) {
-    /* If value is positive and has one digit, just print the digit */
-    putchar(((int) v) + '0');
-    
-  } else {
-    /* Shouldn't happen */
-    fault(__LINE__);
-  }
-}
+#define LINE_MAXLEN (INT32_C(1048576))
 
 /*
- * Print the contents of a listing line structure to standard output.
+ * The suffix appended to a file path to get the path of its undo
+ * journal.
+ */
+#define JOURNAL_SUFFIX ".undo"
+
+/*
+ * The eight-byte signature at the start of an undo journal.
+ */
+#define JOURNAL_SIGNATURE "BPUNDO02"
+
+/*
+ * The size in bytes of the undo journal header and of each record.
  * 
- * Parameters:
+ * The header is the eight-byte signature followed by the record count
+ * and the checksum of the records computed with journalSum(), each as
+ * a u64le.  Each record that follows is the file offset as a u64le, the
+ * byte count as a u8, and then eight bytes holding the original byte
+ * values, of which only the first byte count bytes are used.
  * 
- *   pl - the structure to print
+ * The checksum lets recovery tell a journal whose header reached the
+ * disk before its records from a complete one, without a separate
+ * flush of the records.
  */
-static void printListLine(const LIST_LINE *pl) {
-  
-  int i = 0;
-  
-  /* Check parameter */
-  if (pl == NULL) {
-    fault(__LINE__);
-  }
-  
-  /* Check paragraph number and print address field */
-  if ((pl->para < 0) || (pl->para > INT32_C(0xfffffff))) {
-    fault(__LINE__);
-  }
-  printf("%07lx0:", (long) pl->para);
-  
-  /* Print each byte value */
-  for(i = 0; i < 16; i++) {
-    /* Space is separator, except before element 8 there are three
-     * spaces */
-    if (i == 8) {
-      printf("   ");
-    } else {
-      putchar(' ');
-    }
-    
-    /* Range check byte value and print */
-    if (((pl->bv)[i] >= 0) && ((pl->bv)[i] <= 255)) {
-      /* Unsigned byte value */
-      printf("%02x", (pl->bv)[i]);
-      
-    } else if ((pl->bv)[i] < 0) {
-      /* Missing byte value */
-      printf("  ");
-      
-    } else {
-      /* Invalid byte value */
-      fault(__LINE__);
-    }
-  }
-  
-  /* Print separator between bytes and characters */
-  printf(" | ");
-  
-  /* Print each character value */
-  for(i = 0; i < 16; i++) {
-    /* Range check byte value and print */
-    if (((pl->bv)[i] >= 0x20) && ((pl->bv)[i] <= 0x7e)) {
-      /* US-ASCII printing character */
-      putchar((pl->bv)[i]);
-      
-    } else if ((pl->bv)[i] < 0) {
-      /* Missing byte value */
-      putchar(' ');
-      
-    } else {
-      /* Neither missing nor US-ASCII */
-      putchar('.');
-    }
-  }
-  
-  /* Finally, print the line break */
-  printf("\n");
-}
+#define JOURNAL_HEADER (24)
+#define JOURNAL_RECORD (17)
 
 /*
- * Parse a 64-bit count parameter from a given string.
- * 
- * These strings are unsigned decimal strings that must be in range of
- * int64_t.  -1 is returned if there is a parsing error.
+ * The suffix appended to a file path to get the path of its edit
+ * session file.
+ */
+#define SESSION_SUFFIX ".edit"
+
+/*
+ * The eight-byte signature at the start of an edit session file.
+ */
+#define SESSION_SIGNATURE "BPEDIT01"
+
+/*
+ * The size in bytes of the edit session header and of each piece.
  * 
- * Parameters:
+ * The header is the eight-byte signature followed by the length of the
+ * original file, the piece count, and the add-buffer length, each as a
+ * u64le.  Each piece that follows is the piece kind as a u8, and then
+ * the source offset and the length as u64le.  The add-buffer follows
+ * the pieces.
+ */
+#define SESSION_HEADER (32)
+#define SESSION_PIECE (17)
+
+/*
+ * The maximum number of pieces in an edit session.
+ */
+#define SESSION_MAXPIECES (INT32_C(1048576))
+
+/*
+ * The spare room in bytes given to the add-buffer of an edit session
+ * when it is loaded, which is one page of the buffer pool.
+ */
+#define SESSION_ADDROOM (INT64_C(4096))
+
+/*
+ * The kinds of pieces in an edit session.
  * 
- *   pstr - the string to parse
+ * PIECE_ORIG pieces take their bytes from the original file.  PIECE_ADD
+ * pieces take their bytes from the add-buffer.  PIECE_ZERO pieces are
+ * all zero bytes and have no source.
+ */
+#define PIECE_ORIG (0)
+#define PIECE_ADD  (1)
+#define PIECE_ZERO (2)
+
+/*
+ * The suffix appended to the path of a file to get the path of its
+ * chunk index.
+ */
+#define WALK_SUFFIX ".chunks"
+
+/*
+ * The signature at the start of a complete chunk index.
+ */
+#define WALK_SIGNATURE "BPCHNK02"
+
+/*
+ * The length in bytes of the chunk index header and of each chunk
+ * record within the index.
  * 
- * Return:
+ * The header is the signature, followed by the length of the file, the
+ * number of chunks, the width in bytes of the tag field or zero if
+ * there is none, one if the tag field is big endian or else zero, and
+ * the modification time of the file as returned by fileStamp(), each
+ * as a u64le.
  * 
- *   the unsigned count value, or -1 if parsing error
+ * Each chunk record is the file offset of the chunk, the value of its
+ * tag field, and its payload length, each as a u64le.
  */
-static int64_t parseCount(const char *pstr) {
-  
-  int64_t result = 0;
-  
-  /* Check parameter */
-  if (pstr == NULL) {
-    fault(__LINE__);
+#define WALK_HEADER (48)
+#define WALK_RECORD (24)
+
+/*
+ * The suffix appended to the path of a file to get the path of its
+ * block manifest.
+ */
+#define MANIFEST_SUFFIX ".blocks"
+
+/*
+ * The signature at the start of a complete block manifest.
+ */
+#define MANIFEST_SIGNATURE "BPBLKH01"
+
+/*
+ * The length in bytes of the block manifest header and of each block
+ * record within the manifest.
+ * 
+ * The header is the signature, followed by the length of the file, the
+ * block size, and the modification time of the file in seconds since
+ * the epoch or zero if it is not known, each as a u64le.
+ * 
+ * Each block record is the hash of the block as a u64le.  The last
+ * block is shorter than the block size if the file length is not a
+ * multiple of it.
+ */
+#define MANIFEST_HEADER (32)
+#define MANIFEST_RECORD (8)
+
+/*
+ * The suffix appended to the path of a gzip file to get the path of its
+ * seek-point index.
+ */
+#define GZIP_SUFFIX ".gzi"
+
+/*
+ * The signature at the start of a complete gzip index.
+ */
+#define GZIP_SIGNATURE "BPGZIX02"
+
+/*
+ * The size in bytes of the deflate window.
+ */
+#define GZIP_WINSIZE (32768)
+
+/*
+ * The length in bytes of the gzip index header and of each seek point
+ * record within the index.
+ * 
+ * The header is the signature, followed by the length of the compressed
+ * file, the uncompressed length, the number of seek points, the span
+ * the index was built with, and the modification time of the compressed
+ * file as returned by fileStamp(), each as a u64le, and then the last
+ * eight bytes of the compressed file, which are the CRC32 and ISIZE
+ * trailer of its last member.
+ * 
+ * Each seek point record is the uncompressed offset and the compressed
+ * offset as u64le, followed by one byte with the number of bits of the
+ * preceding compressed byte that belong to the seek point, followed by
+ * the GZIP_WINSIZE bytes of uncompressed data that precede the seek
+ * point, which prime the inflater when restarting there.
+ */
+#define GZIP_HEADER (56)
+#define GZIP_POINT  (17 + GZIP_WINSIZE)
+
+/*
+ * The minimum number of uncompressed bytes between seek points in a
+ * gzip index.
+ * 
+ * Seek points are placed at deflate block boundaries, so the actual
+ * spacing is somewhat larger.  Random access never decompresses more
+ * than about this many bytes before reaching the requested offset,
+ * while the index costs a little over 32K per seek point.  It is set
+ * here to 1M.
+ */
+#define GZIP_SPAN (INT64_C(1048576))
+
+/*
+ * Type declarations
+ * =================
+ */
+
+/*
+ * Structure that stores a single line of data for a listing.
+ */
+typedef struct {
+  
+  /*
+   * The paragraph number to display.
+   * 
+   * This is the 32 least significant bytes of the address, divided by
+   * 16.
+   */
+  int32_t para;
+  
+  /*
+   * The unsigned byte values to display.
+   * 
+   * This array has one element for each byte of the paragraph.
+   * 
+   * Elements that are present must be in range [0, 255].
+   * 
+   * You can also use negative values for elements that are not present,
+   * such as occurs if you have a partial line that goes outside the
+   * boundaries of the range being listed.
+   */
+  int bv[16];
+  
+} LIST_LINE;
+
+/*
+ * Structure that maps a mode keyword to the flags it selects.
+ * 
+ * Mode keyword tables are arrays of these structures, ending with an
+ * entry that has a NULL name.
+ */
+typedef struct {
+  
+  /*
+   * The keyword, or NULL for the end of the table.
+   */
+  const char *pName;
+  
+  /*
+   * The flags selected by the keyword.
+   */
+  int flags;
+  
+} MODE_KEYWORD;
+
+/*
+ * Structure that stores a cache dropper, which asks the operating system
+ * to drop the cached pages of a file behind a scan.
+ */
+typedef struct {
+  
+  /*
+   * A separate read-only descriptor of the file used only for the
+   * requests, or -1 if the dropper is disabled.
+   */
+  int fd;
+  
+  /*
+   * The range scanned since the last request.
+   */
+  int64_t pos;
+  int64_t len;
+  
+} CACHE_DROP;
+
+/*
+ * Structure that stores the byte-range locks held on a file.
+ */
+typedef struct {
+  
+  /*
+   * A separate descriptor of the file that holds the locks, or -1 if no
+   * locks are held.
+   */
+  int fd;
+  
+} RANGE_LOCK;
+
+/*
+ * Structure that stores the buffer pool, which provides the buffers of
+ * the verbs that stream through large ranges, and the memory of edit
+ * sessions, batches, and path lists, which grows with their contents.
+ * 
+ * With a memory budget, the pool is a single page-aligned area that is
+ * allocated once at startup.  Buffers are carved from it in order, each
+ * rounded up to a multiple of POOL_ALIGN, and the area above the last
+ * buffer still in use is reused as buffers are released, so streaming
+ * never allocates memory once it has started.  Without a budget, each
+ * buffer is allocated separately and the pool only keeps statistics.
+ */
+typedef struct {
+  
+  /*
+   * The allocated area and the aligned start of the pool within it, or
+   * NULL if there is no budget.
+   */
+  void *pAlloc;
+  uint8_t *pBase;
+  
+  /*
+   * The budget in bytes, or -1 if there is no budget.
+   */
+  int64_t cap;
+  
+  /*
+   * The buffers in use, in the order they were taken, with the number
+   * of bytes each one occupies.
+   */
+  int count;
+  uint8_t *pBuf[POOL_MAXBUF];
+  int64_t size[POOL_MAXBUF];
+  
+  /*
+   * The number of bytes in use, which with a budget runs up to the end
+   * of the last buffer in use, and the largest this has been.
+   */
+  int64_t used;
+  int64_t peak;
+  
+  /*
+   * The number of buffers taken so far.
+   */
+  int64_t takes;
+  
+} BUFFER_POOL;
+
+/*
+ * Structure that finds holes in a sparse file, so that a scan can skip
+ * reading them.
+ */
+typedef struct {
+  
+  /*
+   * A separate read-only descriptor of the file used only to find
+   * holes, or -1 if hole detection is disabled.
+   */
+  int fd;
+  
+  /*
+   * The most recently found hole, as the file offset where it starts
+   * and the file offset of the data that ends it.
+   */
+  int64_t pos;
+  int64_t end;
+  
+  /*
+   * The length and the block hash of the last range that was hashed as
+   * one whole hole, or zero length if there is none, so that further
+   * holes of the same length need not be hashed again.
+   */
+  int64_t zero_len;
+  uint64_t zero_hash;
+  
+} HOLE_MAP;
+
+/*
+ * Structure that watches a followed file for changes, so that a
+ * follower can wake up as soon as the file is written.
+ */
+typedef struct {
+  
+  /*
+   * An inotify descriptor that watches the file, or -1 if the watch is
+   * disabled and the follower simply waits out its delay.
+   */
+  int fd;
+  
+} FILE_WATCH;
+
+/*
+ * Structure that stores the state of a block hash.
+ * 
+ * The hash is a 64-bit non-cryptographic hash built on the round
+ * function of xxHash64.  Successive 8-byte words of the data are mixed
+ * into four independent lanes in turn, so that the mixing of one word
+ * does not have to wait for the one before.
+ */
+typedef struct {
+  
+  /*
+   * The four lanes.
+   */
+  uint64_t v[4];
+  
+  /*
+   * The number of bytes hashed so far.
+   */
+  int64_t len;
+  
+} BLOCK_HASH;
+
+/*
+ * Structure that stores one worker of a parallel block hash.
+ * 
+ * Each worker has its own view, hole map, cache dropper, and buffer, so
+ * that workers share nothing but the arrays of the round while they
+ * run.
+ */
+typedef struct {
+  
+  /*
+   * The view of the file, non-zero if the worker opened the view itself
+   * rather than borrowing it, and the hole map, cache dropper, and
+   * buffer of BLOCK_SIZE bytes used with it.
+   */
+  AKSVIEW *pv;
+  int owned;
+  HOLE_MAP hm;
+  CACHE_DROP cd;
+  uint8_t *pBuf;
+  
+  /*
+   * The block size and the length of the file.
+   */
+  int64_t bsize;
+  int64_t flen;
+  
+  /*
+   * The share of the current round, which is the blocks from first up
+   * to but excluding last.  Block n is hashed only if pNeed[n - base]
+   * is non-zero, and its hash is stored in pHash[n - base].
+   */
+  int64_t base;
+  int64_t first;
+  int64_t last;
+  const uint8_t *pNeed;
+  uint64_t *pHash;
+  
+#ifdef BINPOKE_THREADS
+  /*
+   * The thread running the share, and non-zero if it was started.
+   */
+  pthread_t thread;
+  int started;
+#endif
+  
+} HASH_WORKER;
+
+/*
+ * Structure that stores a pool of workers that hash the blocks of a
+ * file in rounds.
+ * 
+ * Each round covers up to HASH_ROUND blocks for each worker.  The
+ * results are always used in block order once the round is over, so
+ * the output does not depend on the number of workers.
+ */
+typedef struct {
+  
+  /*
+   * The number of workers and the workers themselves.
+   */
+  int count;
+  HASH_WORKER w[HASH_MAXWORKERS];
+  
+  /*
+   * For each block of the round, non-zero if it is to be hashed, and
+   * its hash.
+   */
+  uint8_t need[HASH_MAXWORKERS * HASH_ROUND];
+  uint64_t hash[HASH_MAXWORKERS * HASH_ROUND];
+  
+} HASH_POOL;
+
+/*
+ * Structure that reads a text file line by line through a block
+ * buffer.
+ */
+typedef struct {
+  
+  /*
+   * View of the text file, its length, and the offset of the next byte
+   * to load into the block buffer.
+   */
+  AKSVIEW *pv;
+  int64_t len;
+  int64_t pos;
+  
+  /*
+   * The block buffer of BLOCK_SIZE bytes, with the offset of the next
+   * byte in it and the number of bytes loaded into it.
+   */
+  uint8_t *pBlk;
+  int32_t blk_pos;
+  int32_t blk_len;
+  
+  /*
+   * The line buffer of LINE_MAXLEN + 1 characters, with the length of
+   * the current line and its line number.
+   */
+  char *pLine;
+  int32_t line_len;
+  int64_t line_num;
+  
+} LINE_READER;
+
+/*
+ * Structure that stores the state of a pass of the import verb.
+ */
+typedef struct {
+  
+  /*
+   * View of the file to write into, or NULL if only checking, and the
+   * length of the file.
+   */
+  AKSVIEW *pv;
+  int64_t flen;
+  
+  /*
+   * The address following the last byte imported, where plain hex data
+   * goes.
+   */
+  int64_t next;
+  
+  /*
+   * The address of the previous listing line, or -1 if none, and the
+   * amount added to eight-digit addresses to undo their wrapping at 4G.
+   */
+  int64_t last_addr;
+  int64_t high;
+  
+  /*
+   * The address and byte values of the previous listing line that a
+   * collapse marker may repeat, or -1 if there is no such line, and
+   * whether a collapse marker is pending.
+   */
+  int64_t pat_addr;
+  int pat_bv[16];
+  int star;
+  
+  /*
+   * The run of consecutive bytes waiting to be written, in a buffer of
+   * BLOCK_SIZE bytes.
+   */
+  uint8_t *pRun;
+  int64_t run_addr;
+  int32_t run_len;
+  
+  /*
+   * The cache dropper of the file, or NULL if only checking.
+   */
+  CACHE_DROP *pCache;
+  
+  /*
+   * The lowest address imported, and the address following the highest
+   * address imported, which are both zero if nothing was imported.
+   */
+  int64_t lo;
+  int64_t hi;
+  
+} IMPORT_STATE;
+
+/*
+ * Structure that stores the layout of chunks for the walk verb.
+ */
+typedef struct {
+  
+  /*
+   * The type of the length field and its offset within the header.
+   */
+  const BINPOKE_TYPE *pLen;
+  int32_t len_off;
+  
+  /*
+   * The type of the tag field, or NULL if there is none, and its offset
+   * within the header.
+   */
+  const BINPOKE_TYPE *pTag;
+  int32_t tag_off;
+  
+  /*
+   * The header size, which is at least one.
+   */
+  int32_t head;
+  
+  /*
+   * The number of bytes after the payload that the length field does
+   * not count.
+   */
+  int64_t tail;
+  
+  /*
+   * The alignment of chunks relative to the start of the walk, which is
+   * at least one.
+   */
+  int64_t align;
+  
+  /*
+   * Non-zero if the length field counts the header as well as the
+   * payload.
+   */
+  int inclusive;
+  
+} CHUNK_LAYOUT;
+
+/*
+ * Structure that stores one piece of an edit session.
+ */
+typedef struct {
+  
+  /*
+   * The kind of piece, one of the PIECE constants.
+   */
+  int kind;
+  
+  /*
+   * The offset of the first byte of the piece in the original file or
+   * in the add-buffer, depending on the kind.  Zero for zero pieces.
+   */
+  int64_t src;
+  
+  /*
+   * The number of bytes in the piece, which is at least one.
+   */
+  int64_t len;
+  
+} PIECE;
+
+/*
+ * Structure that stores an edit session in memory.
+ * 
+ * The logical contents of the file within the session are the
+ * concatenation of all the pieces in the piece table.
+ */
+typedef struct {
+  
+  /*
+   * View of the original file, or NULL.
+   */
+  AKSVIEW *pv;
+  
+  /*
+   * The length of the original file when the session was opened.
+   */
+  int64_t orig_len;
+  
+  /*
+   * The logical length of the file within the session.
+   */
+  int64_t len;
+  
+  /*
+   * The piece table, with its count and allocated capacity.
+   */
+  PIECE *pPiece;
+  int32_t piece_count;
+  int32_t piece_cap;
+  
+  /*
+   * The add-buffer, with its length and allocated capacity.
+   */
+  uint8_t *pAdd;
+  int64_t add_len;
+  int64_t add_cap;
+  
+} EDIT_SESSION;
+
+/*
+ * Structure that stores a random-access reader over the uncompressed
+ * contents of a gzip file.
+ * 
+ * The full definition is only available when compiling with
+ * BINPOKE_GZIP.
+ */
+typedef struct GZ_READER_TAG GZ_READER;
+
+#ifdef BINPOKE_GZIP
+struct GZ_READER_TAG {
+  
+  /*
+   * View of the compressed file, its length, its modification time as
+   * returned by fileStamp(), and its last eight bytes as a u64le, or
+   * zero if it is shorter than that.
+   */
+  AKSVIEW *pv;
+  int64_t comp_len;
+  int64_t stamp;
+  uint64_t trailer;
+  
+  /*
+   * View of the seek-point index sidecar.
+   */
+  AKSVIEW *pi;
+  
+  /*
+   * The uncompressed length, and the number of seek points in the
+   * index.
+   */
+  int64_t len;
+  int64_t point_count;
+  
+  /*
+   * The inflater, which is only valid while active is non-zero.
+   * 
+   * While active, in_pos is the offset in the compressed file of the
+   * next byte to load into the input buffer, and out_pos is the
+   * uncompressed offset of the next byte the inflater will produce.
+   * The wrapped flag is zero while the inflater decodes raw deflate
+   * data from a seek point, and non-zero once it has moved on to a
+   * later member, whose gzip header and trailer it then decodes too.
+   */
+  z_stream strm;
+  int active;
+  int wrapped;
+  int64_t in_pos;
+  int64_t out_pos;
+  
+  /*
+   * The input buffer and scratch buffer of BLOCK_SIZE bytes each, and
+   * the window buffer of GZIP_WINSIZE bytes.
+   */
+  uint8_t *pIn;
+  uint8_t *pSkip;
+  uint8_t *pWin;
+  
+};
+#endif
+
+/*
+ * Structure that selects where a read-only verb gets its bytes from.
+ * 
+ * If pe is not NULL, bytes come from the edit session.  Otherwise, if
+ * pz is not NULL, bytes come from the gzip reader.  Otherwise, bytes
+ * come from the libbinpoke handle pb.
+ */
+typedef struct {
+  
+  BINPOKE *pb;
+  const EDIT_SESSION *pe;
+  GZ_READER *pz;
+  
+} BYTE_SOURCE;
+
+/*
+ * Local data
+ * ==========
+ */
+
+/*
+ * The executable module name, used in diagnostic messages.
+ * 
+ * Set at the start of the program entrypoint.
+ */
+const char *pModule = NULL;
+
+/*
+ * The buffer pool, which has no budget unless one is set by the
+ * --max-memory option.
+ */
+static BUFFER_POOL bufPool = {NULL, NULL, -1, 0, {NULL}, {0}, 0, 0, 0};
+
+/*
+ * The prepositions that begin a phrase, ending with NULL.
+ */
+static const char *prepTable[] = {
+  "from", "for", "at", "as", "with", "in", "to", NULL
+};
+
+/*
+ * The mode keywords of the list verb.
+ */
+static const MODE_KEYWORD listModes[] = {
+  {"full", 0},
+  {"collapse", LIST_MODE_COLLAPSE},
+  {"follow", LIST_MODE_FOLLOW},
+  {"session", LIST_MODE_SESSION},
+#ifdef BINPOKE_GZIP
+  {"gzip", LIST_MODE_GZIP},
+#endif
+#ifdef BINPOKE_FADVISE
+  {"nocache", SCAN_MODE_NOCACHE},
+#endif
+#ifdef BINPOKE_LOCK
+  {"wait", LOCK_MODE_WAIT},
+#endif
+  {NULL, 0}
+};
+
+/*
+ * The mode keywords of the write, resize, insert, and remove verbs.
+ */
+static const MODE_KEYWORD editModes[] = {
+  {"direct", 0},
+  {"session", EDIT_MODE_SESSION},
+#ifdef BINPOKE_LOCK
+  {"wait", LOCK_MODE_WAIT},
+#endif
+  {NULL, 0}
+};
+
+/*
+ * The mode keywords of the read verb.
+ */
+static const MODE_KEYWORD readModes[] = {
+  {"direct", 0},
+  {"session", EDIT_MODE_SESSION},
+#ifdef BINPOKE_GZIP
+  {"gzip", EDIT_MODE_GZIP},
+#endif
+#ifdef BINPOKE_LOCK
+  {"wait", LOCK_MODE_WAIT},
+#endif
+  {NULL, 0}
+};
+
+/*
+ * The mode keywords of the batch verb.
+ */
+static const MODE_KEYWORD batchModes[] = {
+  {"direct", 0},
+  {"journal", BATCH_MODE_JOURNAL},
+#ifdef BINPOKE_LOCK
+  {"wait", LOCK_MODE_WAIT},
+#endif
+  {NULL, 0}
+};
+
+/*
+ * The mode keywords of the query verb.
+ */
+static const MODE_KEYWORD queryModes[] = {
+  {"single", 0},
+  {"list", QUERY_MODE_LIST},
+#ifdef BINPOKE_GZIP
+  {"gzip", QUERY_MODE_GZIP},
+#endif
+  {NULL, 0}
+};
+
+/*
+ * The mode keywords of the xform verb.
+ */
+static const MODE_KEYWORD xformModes[] = {
+  {"xor", XFORM_MODE_XOR},
+  {"and", XFORM_MODE_AND},
+  {"or", XFORM_MODE_OR},
+#ifdef BINPOKE_FADVISE
+  {"nocache", SCAN_MODE_NOCACHE},
+#endif
+#ifdef BINPOKE_LOCK
+  {"wait", LOCK_MODE_WAIT},
+#endif
+  {NULL, 0}
+};
+
+/*
+ * The mode keywords of the swap and import verbs.
+ */
+static const MODE_KEYWORD scanModes[] = {
+  {"cached", 0},
+#ifdef BINPOKE_FADVISE
+  {"nocache", SCAN_MODE_NOCACHE},
+#endif
+#ifdef BINPOKE_LOCK
+  {"wait", LOCK_MODE_WAIT},
+#endif
+  {NULL, 0}
+};
+
+/*
+ * The mode keywords of the changed verb.
+ */
+static const MODE_KEYWORD changedModes[] = {
+  {"quick", 0},
+  {"full", CHANGED_MODE_FULL},
+  {"update", CHANGED_MODE_UPDATE},
+#ifdef BINPOKE_FADVISE
+  {"nocache", SCAN_MODE_NOCACHE},
+#endif
+#ifdef BINPOKE_LOCK
+  {"wait", LOCK_MODE_WAIT},
+#endif
+  {NULL, 0}
+};
+
+/*
+ * The mode keywords of the walk verb.
+ */
+static const MODE_KEYWORD walkModes[] = {
+  {"table", 0},
+  {"index", WALK_MODE_INDEX},
+#ifdef BINPOKE_FADVISE
+  {"nocache", SCAN_MODE_NOCACHE},
+#endif
+  {NULL, 0}
+};
+
+/*
+ * The type used for integer fields within sidecar files, which is u64le.
+ * 
+ * This is looked up in the libbinpoke type table when the program
+ * starts.
+ */
+static const BINPOKE_TYPE *pSidecarType = NULL;
+
+/*
+ * Local functions
+ * ===============
+ */
+
+/* Prototypes */
+static void fault(int line);
+static void pauseMillis(int32_t ms);
+static void fprintInt64(FILE *pOut, int64_t v);
+static void printInt64(int64_t v);
+static void printUint64(uint64_t v);
+static void printValue(const BINPOKE_TYPE *pt, uint64_t v);
+static void printListLine(const LIST_LINE *pl);
+
+static int parseMode(const char *pstr, const MODE_KEYWORD *pTable);
+static int isPreposition(const char *pstr);
+
+static uint64_t readInt(AKSVIEW *pv, int64_t pos, const BINPOKE_TYPE *pt);
+static void writeInt(
+    AKSVIEW *pv,
+    int64_t pos,
+    const BINPOKE_TYPE *pt,
+    uint64_t v);
+
+static void readBlock(
+    AKSVIEW *pv,
+    int64_t pos,
+    uint8_t *pBuf,
+    int32_t len);
+
+static void writeBlock(
+    AKSVIEW *pv,
+    int64_t pos,
+    const uint8_t *pBuf,
+    int32_t len);
+
+static void swapBlock(uint8_t *pBuf, int32_t len, int width);
+
+static void moveRange(
+    AKSVIEW *pv,
+    int64_t src,
+    int64_t dest,
+    int64_t count,
+    uint8_t *pBuf);
+
+#ifdef BINPOKE_FALLOCATE
+static int shiftRange(
+    const char *pPath,
+    int64_t pos,
+    int64_t len,
+    int insert);
+#endif
+
+static char *sidecarPath(const char *pPath, const char *pSuffix);
+#ifdef AKS_WIN
+static wchar_t *widePath(const char *pPath);
+#endif
+static int fileExists(const char *pPath);
+static int64_t fileLength(const char *pPath);
+static int sameFile(const char *pPathA, const char *pPathB);
+static int syncFile(const char *pPath);
+static int syncParent(const char *pPath);
+
+static int poolInit(int64_t cap);
+static void poolStats(void);
+static void poolRelease(void);
+static void *bufAlloc(int64_t len);
+static void bufFree(void *p);
+static void *bufGrow(void *p, int64_t len);
+static int64_t bufRoom(void);
+
+static int lockRange(
+    RANGE_LOCK *pk,
+    const char *pPath,
+    int64_t pos,
+    int64_t len,
+    int excl,
+    int wait);
+static void lockRelease(RANGE_LOCK *pk);
+
+static void cacheOpen(CACHE_DROP *pc, const char *pPath, int enable);
+static void cacheDrop(CACHE_DROP *pc, int64_t pos, int64_t len);
+static void cacheFlush(CACHE_DROP *pc);
+static void cacheClose(CACHE_DROP *pc);
+
+static void holeOpen(HOLE_MAP *ph, const char *pPath);
+static int holeCheck(HOLE_MAP *ph, int64_t pos, int64_t len);
+static void holeClose(HOLE_MAP *ph);
+
+static void watchOpen(FILE_WATCH *pw, const char *pPath);
+static void watchWait(FILE_WATCH *pw, int32_t ms);
+static void watchClose(FILE_WATCH *pw);
+
+static void sessionFree(EDIT_SESSION *pe);
+static int sessionLoad(EDIT_SESSION *pe, const char *pPath, int vmode);
+static int sessionSave(const EDIT_SESSION *pe, const char *pPath);
+
+static int sessionAddPiece(
+    EDIT_SESSION *pe,
+    int32_t i,
+    int kind,
+    int64_t src,
+    int64_t len);
+
+static int32_t sessionSplit(EDIT_SESSION *pe, int64_t pos);
+
+static int sessionInsert(
+    EDIT_SESSION *pe,
+    int64_t pos,
+    const uint8_t *pData,
+    int64_t len);
+
+static int sessionRemove(EDIT_SESSION *pe, int64_t pos, int64_t len);
+
+static void sessionRead(
+    const EDIT_SESSION *pe,
+    int64_t pos,
+    uint8_t *pBuf,
+    int32_t len);
+
+static int sessionCommit(const EDIT_SESSION *pe, uint8_t *pBuf);
+
+#ifdef BINPOKE_GZIP
+static voidpf gzAlloc(voidpf opaque, uInt items, uInt size);
+static void gzFree(voidpf opaque, voidpf address);
+static int gzStart(z_stream *pstrm, int bits);
+static int gzAddPoint(
+    AKSVIEW *pi,
+    int64_t k,
+    int64_t out,
+    int64_t in,
+    int bits,
+    const uint8_t *pWin,
+    int32_t left,
+    uint8_t *pBuf);
+static int gzBuildIndex(GZ_READER *pz);
+static int gzCheckIndex(GZ_READER *pz);
+static int gzOpen(GZ_READER *pz, const char *pPath);
+static void gzClose(GZ_READER *pz);
+static int gzInflate(GZ_READER *pz, uint8_t *pOut, int32_t n);
+static int gzRead(GZ_READER *pz, int64_t pos, uint8_t *pBuf, int32_t len);
+#endif
+
+static int sourceRead(
+    BYTE_SOURCE *ps,
+    int64_t pos,
+    uint8_t *pBuf,
+    int32_t len);
+
+static int hexDigit(int c);
+static int lineRead(LINE_READER *pr);
+static void importFlush(IMPORT_STATE *pis);
+static int importByte(IMPORT_STATE *pis, int64_t addr, int v);
+static int importHex(
+    IMPORT_STATE *pis,
+    const char *pstr,
+    int64_t addr,
+    int64_t line);
+static int importLine(IMPORT_STATE *pis, char *pLine, int64_t line);
+static int importPass(
+    AKSVIEW *pl,
+    AKSVIEW *pv,
+    CACHE_DROP *pCache,
+    int64_t flen,
+    int64_t start,
+    uint8_t *pBlk,
+    uint8_t *pRun,
+    char *pLine,
+    int64_t *pSpan);
+
+static void xformBlock(
+    uint8_t *pBuf,
+    const uint8_t *pPat,
+    int32_t len,
+    int mode);
+
+static int parseLayout(const char *pstr, CHUNK_LAYOUT *pl);
+static void printChunk(
+    int64_t n,
+    int64_t offset,
+    const BINPOKE_TYPE *pt,
+    uint64_t tag,
+    int64_t len);
+static AKSVIEW *chunkOpen(
+    const char *pPath,
+    int64_t flen,
+    int64_t *pCount,
+    const BINPOKE_TYPE **ppt);
+
+static void stringsClassify(
+    const uint8_t *pBuf,
+    uint8_t *pFlag,
+    int32_t len);
+static int32_t stringsSpan(
+    const uint8_t *pFlag,
+    int32_t i,
+    int32_t len,
+    int v);
+static int32_t stringsSkip(
+    const uint8_t *pFlag,
+    int32_t i,
+    int32_t len,
+    int32_t minlen);
+
+static uint64_t hashRound(uint64_t acc, uint64_t w);
+static uint64_t hashWord(const uint8_t *pBytes);
+static void hashStart(BLOCK_HASH *pb);
+static void hashUpdate(BLOCK_HASH *pb, const uint8_t *pBuf, int32_t len);
+static uint64_t hashFinish(const BLOCK_HASH *pb);
+static uint64_t hashRange(
+    AKSVIEW *pv,
+    HOLE_MAP *ph,
+    CACHE_DROP *pc,
+    int64_t pos,
+    int64_t len,
+    uint8_t *pBuf);
+static uint64_t journalSum(uint64_t acc, const uint8_t *pRec);
+static int64_t blockLen(int64_t n, int64_t bsize, int64_t flen);
+static int hashPoolOpen(
+    HASH_POOL *pp,
+    AKSVIEW *pv,
+    const char *pPath,
+    int nocache,
+    int64_t bsize,
+    int64_t flen);
+static void *hashWork(void *pArg);
+static void hashPoolRun(HASH_POOL *pp, int64_t base, int64_t end);
+static void hashPoolClose(HASH_POOL *pp);
+static int64_t fileStamp(const char *pPath);
+static int32_t mirrorSpan(
+    const uint8_t *pSrc,
+    const uint8_t *pDst,
+    int32_t i,
+    int32_t len,
+    int same);
+static AKSVIEW *manifestOpen(
+    const char *pPath,
+    int writable,
+    int64_t *pLen,
+    int64_t *pBlock,
+    int64_t *pStamp);
+
+static int readListChar(BINPOKE *pb, int64_t *pPos);
+static void printQuery(const char *pPath, int64_t flen, int errcode);
+static int queryFile(const char *pPath);
+static int queryList(const char *pList);
+static int readToken(
+    BINPOKE *pb,
+    int64_t *pPos,
+    char *pBuf,
+    int bufsize);
+
+static int listRange(
+    BYTE_SOURCE *ps,
+    CACHE_DROP *pc,
+    int64_t addr,
+    int64_t count,
+    int mode);
+
+static int verb_list(
+    const char *pPath,
+    const char *pFrom,
+    const char *pFor,
+    const char *pIn);
+
+static int verb_read(
+    const char *pPath,
+    const char *pAt,
+    const char *pAs,
+    const char *pIn);
+
+static int verb_write(
+    const char *pPath,
+    const char *pAt,
+    const char *pAs,
+    const char *pWith,
+    const char *pIn);
+
+static int verb_query(char **ppPath, int pathc, const char *pIn);
+
+static int verb_resize(
+    const char *pPath,
+    const char *pWith,
+    const char *pIn);
+
+static int verb_batch(
+    const char *pPath,
+    const char *pWith,
+    const char *pIn);
+
+static int verb_recover(const char *pPath);
+
+static int verb_swap(
+    const char *pPath,
+    const char *pFrom,
+    const char *pFor,
+    const char *pAs,
+    const char *pIn);
+
+static int verb_insert(
+    const char *pPath,
+    const char *pAt,
+    const char *pFor,
+    const char *pIn);
+
+static int verb_remove(
+    const char *pPath,
+    const char *pFrom,
+    const char *pFor,
+    const char *pIn);
+
+static int verb_import(
+    const char *pPath,
+    const char *pWith,
+    const char *pAt,
+    const char *pIn);
+
+static int verb_xform(
+    const char *pPath,
+    const char *pFrom,
+    const char *pFor,
+    const char *pWith,
+    const char *pAs,
+    const char *pIn,
+    const char *pTo);
+
+static int verb_walk(
+    const char *pPath,
+    const char *pAt,
+    const char *pAs,
+    const char *pFor,
+    const char *pIn);
+static int verb_chunk(const char *pPath, const char *pAt);
+
+static int verb_strings(
+    const char *pPath,
+    const char *pFrom,
+    const char *pFor,
+    const char *pWith,
+    const char *pIn);
+
+static int verb_manifest(
+    const char *pPath,
+    const char *pWith,
+    const char *pIn);
+static int verb_changed(const char *pPath, const char *pIn);
+
+static int verb_mirror(
+    const char *pPath,
+    const char *pWith,
+    const char *pIn);
+
+static int verb_begin(const char *pPath);
+static int verb_commit(const char *pPath);
+static int verb_abort(const char *pPath);
+
+static int verb_require(const char *pPath);
+static int verb_new(const char *pPath);
+
+/*
+ * Invoked when there is an unexpected error condition.
+ * 
+ * Prints a diagnostic message to stderr and then exits program with
+ * failure code.
+ * 
+ * Parameters:
+ * 
+ *   line - the line number of the fault in this source file
+ * 
+ * Return:
+ * 
+ *   this function never returns
+ */
+static void fault(int line) {
+  fprintf(stderr, "Fault in binpoke at line %d\n", line);
+  exit(EXIT_FAILURE);
+}
+
+/*
+ * Suspend the program for a given number of milliseconds.
+ * 
+ * Parameters:
+ * 
+ *   ms - the number of milliseconds, which must be in range [0, 999999]
+ */
+static void pauseMillis(int32_t ms) {
+#ifdef AKS_WIN
+  /* Check parameter */
+  if ((ms < 0) || (ms > INT32_C(999999))) {
+    fault(__LINE__);
+  }
+  
+  /* Sleep */
+  Sleep((DWORD) ms);
+#else
+  struct timespec ts;
+  
+  /* Check parameter */
+  if ((ms < 0) || (ms > INT32_C(999999))) {
+    fault(__LINE__);
+  }
+  
+  /* Sleep */
+  memset(&ts, 0, sizeof(struct timespec));
+  ts.tv_sec = (time_t) (ms / 1000);
+  ts.tv_nsec = ((long) (ms % 1000)) * 1000000L;
+  nanosleep(&ts, NULL);
+#endif
+}
+
+/*
+ * Print a signed 64-bit integer value in decimal to an output stream.
+ * 
+ * This does not depend on the width of long, which is only 32 bits on
+ * some platforms.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the stream to print to
+ * 
+ *   v - the integer value to print
+ */
+static void fprintInt64(FILE *pOut, int64_t v) {
+  
+  /* Check parameter */
+  if (pOut == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Handle the different cases */
+  if (v <= INT64_MIN) {
+    /* Special case of the least negative value -- this integer value
+     * has no positive equivalent due to the way two's complement works,
+     * so just print its value as a special case */
+    fputs("-9223372036854775808", pOut);
+    
+  } else if ((v > INT64_MIN) && (v < 0)) {
+    /* If we have a negative value besides the least negative value that
+     * we just handled as a special case, print a negative sign and then
+     * recursively print the positive value */
+    fputc('-', pOut);
+    fprintInt64(pOut, 0 - v);
+    
+  } else if (v >= 10) {
+    /* If value is positive and has more than one digit, first
+     * recursively print the value except for the last digit */
+    fprintInt64(pOut, v / 10);
+    
+    /* Finally, print the last digit */
+    fputc(((int) (v % 10)) + '0', pOut);
+    
+  } else if ((v >= 0) && (v < 10)) {
+    /* If value is positive and has one digit, just print the digit */
+    fputc(((int) v) + '0', pOut);
+    
+  } else {
+    /* Shouldn't happen */
+    fault(__LINE__);
+  }
+}
+
+/*
+ * Print a signed 64-bit integer value in decimal to standard output.
+ * 
+ * Parameters:
+ * 
+ *   v - the integer value to print
+ */
+static void printInt64(int64_t v) {
+  fprintInt64(stdout, v);
+}
+
+/*
+ * Print an unsigned 64-bit integer value in decimal to standard output.
+ * 
+ * Parameters:
+ * 
+ *   v - the integer value to print
+ */
+static void printUint64(uint64_t v) {
+  
+  /* If value has more than one digit, first recursively print the value
+   * except for the last digit */
+  if (v >= 10) {
+    printUint64(v / 10);
+  }
+  
+  /* Print the last digit */
+  putchar(((int) (v % 10)) + '0');
+}
+
+/*
+ * Print an integer value of a given type in decimal to standard output.
+ * 
+ * v holds the two's-complement bits of the integer, with only the bits
+ * that fit within the type width being significant.  Signed types are
+ * sign-extended before printing.
+ * 
+ * Parameters:
+ * 
+ *   pt - the integer type
+ * 
+ *   v - the bits of the integer value to print
+ */
+static void printValue(const BINPOKE_TYPE *pt, uint64_t v) {
+  
+  uint64_t umax = 0;
+  
+  /* Check parameter */
+  if (pt == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Get the maximum unsigned value of the type and mask the value */
+  if (pt->width >= 8) {
+    umax = UINT64_MAX;
+  } else {
+    umax = (UINT64_C(1) << (pt->width * 8)) - 1;
+  }
+  v &= umax;
+  
+  /* Handle the different cases */
+  if (!(pt->sgn)) {
+    /* Unsigned value */
+    printUint64(v);
+    
+  } else {
+    /* Signed value, so sign-extend if the sign bit of the type is set */
+    if (v > (umax >> 1)) {
+      v |= ~umax;
+    }
+    
+    /* Convert to signed without relying on implementation-defined
+     * conversions */
+    if (v > INT64_MAX) {
+      printInt64(0 - ((int64_t) (~v)) - 1);
+    } else {
+      printInt64((int64_t) v);
+    }
+  }
+}
+
+/*
+ * Print the contents of a listing line structure to standard output.
+ * 
+ * Parameters:
+ * 
+ *   pl - the structure to print
+ */
+static void printListLine(const LIST_LINE *pl) {
+  
+  char line[BINPOKE_LINESIZE];
+  
+  /* Check parameter */
+  if (pl == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Check paragraph number, then format and print the line */
+  if ((pl->para < 0) || (pl->para > INT32_C(0xfffffff))) {
+    fault(__LINE__);
+  }
+  if (!binpoke_formatline(line, ((int64_t) pl->para) * 16, pl->bv,
+        NULL)) {
+    fault(__LINE__);
+  }
+  printf("%s\n", line);
+}
+
+/*
+ * Parse a mode from a given string.
+ * 
+ * The string is a sequence of one or more mode keywords separated by
+ * commas, with no whitespace.  Each keyword must be one of the keywords
+ * in the given table.
+ * 
+ * The return value is the combination of all flags that were selected
+ * by the keywords, or -1 if there is a parsing error.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ *   pTable - the table of recognized keywords
+ * 
+ * Return:
+ * 
+ *   the mode flags, or -1 if parsing error
+ */
+static int parseMode(const char *pstr, const MODE_KEYWORD *pTable) {
+  
+  int result = 0;
+  size_t klen = 0;
+  const MODE_KEYWORD *pk = NULL;
+  
+  /* Check parameters */
+  if ((pstr == NULL) || (pTable == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Parse each keyword */
+  while (result >= 0) {
+    /* Get the length of the current keyword */
+    klen = strcspn(pstr, ",");
+    
+    /* Look up the current keyword in the table */
+    for(pk = pTable; pk->pName != NULL; pk++) {
+      if ((strlen(pk->pName) == klen) &&
+          (strncmp(pstr, pk->pName, klen) == 0)) {
+        break;
+      }
+    }
+    
+    /* Add the flags of the keyword to the result, or fail if the
+     * keyword is empty or unrecognized */
+    if (pk->pName != NULL) {
+      result |= pk->flags;
+    } else {
+      result = -1;
+    }
+    
+    /* Leave loop if this was the last keyword, else skip the comma */
+    if (pstr[klen] == 0) {
+      break;
+    }
+    pstr += klen + 1;
+  }
+  
+  /* Return result or -1 */
+  return result;
+}
+
+/*
+ * Check whether a string is one of the prepositions that begin a
+ * phrase.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to check
+ * 
+ * Return:
+ * 
+ *   non-zero if the string is a preposition, zero if not
+ */
+static int isPreposition(const char *pstr) {
+  
+  int result = 0;
+  int i = 0;
+  
+  /* Check parameter */
+  if (pstr == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Look up the string in the table */
+  for(i = 0; prepTable[i] != NULL; i++) {
+    if (strcmp(pstr, prepTable[i]) == 0) {
+      result = 1;
+      break;
+    }
+  }
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Read the bits of an integer from a view.
+ * 
+ * The caller must ensure that all component bytes of the integer are
+ * within the file limits.  No sign extension is performed.
+ * 
+ * Parameters:
+ * 
+ *   pv - the view to read from
+ * 
+ *   pos - the file offset of the first byte of the integer
+ * 
+ *   pt - the integer type
+ * 
+ * Return:
+ * 
+ *   the bits of the integer
+ */
+static uint64_t readInt(AKSVIEW *pv, int64_t pos, const BINPOKE_TYPE *pt) {
+  
+  uint8_t buf[8];
+  
+  /* Check parameters */
+  if ((pv == NULL) || (pos < 0) || (pt == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Read the bytes and decode them */
+  readBlock(pv, pos, buf, pt->width);
+  return binpoke_decode(buf, pt);
+}
+
+/*
+ * Write the bits of an integer to a view.
+ * 
+ * The caller must ensure that all component bytes of the integer are
+ * within the file limits.  Bits beyond the width of the type are
+ * ignored.
+ * 
+ * Parameters:
+ * 
+ *   pv - the view to write to
+ * 
+ *   pos - the file offset of the first byte of the integer
+ * 
+ *   pt - the integer type
+ * 
+ *   v - the bits of the integer
+ */
+static void writeInt(
+    AKSVIEW *pv,
+    int64_t pos,
+    const BINPOKE_TYPE *pt,
+    uint64_t v) {
+  
+  uint8_t buf[8];
+  
+  /* Check parameters */
+  if ((pv == NULL) || (pos < 0) || (pt == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Encode the bytes and write them */
+  binpoke_encode(buf, pt, v);
+  writeBlock(pv, pos, buf, pt->width);
+}
+
+/*
+ * Read a block of bytes from a view into a buffer.
+ * 
+ * The caller must ensure that the whole block is within the file
+ * limits.
+ * 
+ * Parameters:
+ * 
+ *   pv - the view to read from
+ * 
+ *   pos - the file offset of the first byte of the block
+ * 
+ *   pBuf - the buffer to receive the bytes
+ * 
+ *   len - the number of bytes to read
+ */
+static void readBlock(
+    AKSVIEW *pv,
+    int64_t pos,
+    uint8_t *pBuf,
+    int32_t len) {
+  
+  int32_t i = 0;
+  
+  /* Check parameters */
+  if ((pv == NULL) || (pos < 0) || (pBuf == NULL) || (len < 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Read each byte */
+  for(i = 0; i < len; i++) {
+    pBuf[i] = (uint8_t) aksview_read8u(pv, pos + ((int64_t) i));
+  }
+}
+
+/*
+ * Write a block of bytes from a buffer to a view.
+ * 
+ * The caller must ensure that the whole block is within the file
+ * limits.
+ * 
+ * Parameters:
+ * 
+ *   pv - the view to write to
+ * 
+ *   pos - the file offset of the first byte of the block
+ * 
+ *   pBuf - the bytes to write
+ * 
+ *   len - the number of bytes to write
+ */
+static void writeBlock(
+    AKSVIEW *pv,
+    int64_t pos,
+    const uint8_t *pBuf,
+    int32_t len) {
+  
+  int32_t i = 0;
+  
+  /* Check parameters */
+  if ((pv == NULL) || (pos < 0) || (pBuf == NULL) || (len < 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Write each byte */
+  for(i = 0; i < len; i++) {
+    aksview_write8(pv, pos + ((int64_t) i), pBuf[i]);
+  }
+}
+
+/*
+ * Reverse the byte order of every element in a block.
+ * 
+ * There is a separate loop for each element width, each with a fixed
+ * pattern of byte moves, rather than one loop over a variable width.
+ * Compilers turn fixed patterns like these into vector shuffles, such
+ * as pshufb on x86 when SSSE3 is enabled, without any intrinsics.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the block
+ * 
+ *   len - the number of bytes in the block, which must be a multiple of
+ *   the element width
+ * 
+ *   width - the element width in bytes, which must be 2, 4, or 8
+ */
+static void swapBlock(uint8_t *pBuf, int32_t len, int width) {
+  
+  int32_t i = 0;
+  uint8_t t0 = 0;
+  uint8_t t1 = 0;
+  uint8_t t2 = 0;
+  uint8_t t3 = 0;
+  
+  /* Check parameters */
+  if ((pBuf == NULL) || (len < 0) ||
+      ((width != 2) && (width != 4) && (width != 8)) ||
+      (len % width != 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Reverse each element */
+  if (width == 2) {
+    for(i = 0; i < len; i += 2) {
+      t0 = pBuf[i];
+      pBuf[i] = pBuf[i + 1];
+      pBuf[i + 1] = t0;
+    }
+    
+  } else if (width == 4) {
+    for(i = 0; i < len; i += 4) {
+      t0 = pBuf[i];
+      t1 = pBuf[i + 1];
+      pBuf[i] = pBuf[i + 3];
+      pBuf[i + 1] = pBuf[i + 2];
+      pBuf[i + 2] = t1;
+      pBuf[i + 3] = t0;
+    }
+    
+  } else {
+    for(i = 0; i < len; i += 8) {
+      t0 = pBuf[i];
+      t1 = pBuf[i + 1];
+      t2 = pBuf[i + 2];
+      t3 = pBuf[i + 3];
+      pBuf[i] = pBuf[i + 7];
+      pBuf[i + 1] = pBuf[i + 6];
+      pBuf[i + 2] = pBuf[i + 5];
+      pBuf[i + 3] = pBuf[i + 4];
+      pBuf[i + 4] = t3;
+      pBuf[i + 5] = t2;
+      pBuf[i + 6] = t1;
+      pBuf[i + 7] = t0;
+    }
+  }
+}
+
+/*
+ * Move a range of bytes within a view to another offset.
+ * 
+ * The source and destination ranges may overlap.  The move is done in
+ * blocks through the given buffer of BLOCK_SIZE bytes, working from the
+ * end of the range backwards when moving towards higher offsets and from
+ * the start forwards otherwise, so that no byte is overwritten before
+ * it has been moved.
+ * 
+ * The caller must ensure that both ranges are within the file limits.
+ * 
+ * Parameters:
+ * 
+ *   pv - the view
+ * 
+ *   src - the file offset of the first byte to move
+ * 
+ *   dest - the file offset to move the first byte to
+ * 
+ *   count - the number of bytes to move
+ * 
+ *   pBuf - a buffer of BLOCK_SIZE bytes
+ */
+static void moveRange(
+    AKSVIEW *pv,
+    int64_t src,
+    int64_t dest,
+    int64_t count,
+    uint8_t *pBuf) {
+  
+  int64_t done = 0;
+  int32_t blen = 0;
+  
+  /* Check parameters */
+  if ((pv == NULL) || (src < 0) || (dest < 0) || (count < 0) ||
+      (pBuf == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Move each block in the appropriate direction */
+  for(done = 0; done < count; done += blen) {
+    if (count - done < BLOCK_SIZE) {
+      blen = (int32_t) (count - done);
+    } else {
+      blen = BLOCK_SIZE;
+    }
+    
+    if (dest > src) {
+      readBlock(pv, src + count - done - blen, pBuf, blen);
+      writeBlock(pv, dest + count - done - blen, pBuf, blen);
+    } else {
+      readBlock(pv, src + done, pBuf, blen);
+      writeBlock(pv, dest + done, pBuf, blen);
+    }
+  }
+}
+
+#ifdef BINPOKE_FALLOCATE
+/*
+ * Insert or collapse a range of a file within the filesystem, so that
+ * everything after the range is shifted without being copied.
+ * 
+ * This uses fallocate() with FALLOC_FL_INSERT_RANGE or
+ * FALLOC_FL_COLLAPSE_RANGE on a separate descriptor of the file.  Only
+ * some filesystems support this, such as ext4 and XFS, and only when
+ * the offset and length are multiples of the filesystem block size.
+ * An inserted range must start before the end of the file, and a
+ * collapsed range must end before it.  An inserted range reads as zero
+ * bytes.
+ * 
+ * No view of the file may be open, since it would not see the change
+ * in length.  If the shift can not be done for any reason, the file is
+ * left unchanged and the caller must move the bytes itself.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pos - the file offset of the range
+ * 
+ *   len - the length of the range, which must be at least one
+ * 
+ *   insert - non-zero to insert the range, zero to collapse it
+ * 
+ * Return:
+ * 
+ *   non-zero if the range was shifted, zero if the file is unchanged
+ */
+static int shiftRange(
+    const char *pPath,
+    int64_t pos,
+    int64_t len,
+    int insert) {
+  
+  int result = 0;
+  int fd = -1;
+  int64_t bsize = 0;
+  struct stat st;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pos < 0) || (len < 1)) {
+    fault(__LINE__);
+  }
+  
+  /* Open a separate descriptor, and only ask the filesystem if the
+   * range is aligned to its block size and lies where it must */
+  fd = open(pPath, O_RDWR);
+  if (fd >= 0) {
+    if (fstat(fd, &st) == 0) {
+      bsize = (int64_t) st.st_blksize;
+      if ((bsize > 0) && (pos % bsize == 0) && (len % bsize == 0)) {
+        if (insert && (pos < (int64_t) st.st_size)) {
+          if (fallocate(fd, FALLOC_FL_INSERT_RANGE,
+                (off_t) pos, (off_t) len) == 0) {
+            result = 1;
+          }
+          
+        } else if ((!insert) && (len < (int64_t) st.st_size - pos)) {
+          if (fallocate(fd, FALLOC_FL_COLLAPSE_RANGE,
+                (off_t) pos, (off_t) len) == 0) {
+            result = 1;
+          }
+        }
+      }
+    }
+    close(fd);
+  }
+  
+  /* Return result */
+  return result;
+}
+#endif
+
+/*
+ * Get the path of a sidecar file for a given file path.
+ * 
+ * The sidecar path is the file path with the given suffix appended.
+ * 
+ * The returned string is dynamically allocated and must be released
+ * with free() by the caller.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pSuffix - the suffix of the sidecar file
+ * 
+ * Return:
+ * 
+ *   the path to the sidecar file
+ */
+static char *sidecarPath(const char *pPath, const char *pSuffix) {
+  
+  char *pResult = NULL;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pSuffix == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Allocate and build the path */
+  pResult = (char *) malloc(strlen(pPath) + strlen(pSuffix) + 1);
+  if (pResult == NULL) {
+    fault(__LINE__);
+  }
+  strcpy(pResult, pPath);
+  strcat(pResult, pSuffix);
+  
+  /* Return result */
+  return pResult;
+}
+
+#ifdef AKS_WIN
+/*
+ * Convert a UTF-8 file path to the wide-character form that the
+ * Windows API takes.
+ * 
+ * The returned string is dynamically allocated and must be released
+ * with free() by the caller.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ * Return:
+ * 
+ *   the wide-character path, or NULL if the path is not valid UTF-8
+ */
+static wchar_t *widePath(const char *pPath) {
+  
+  wchar_t *pResult = NULL;
+  int n = 0;
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Get the length of the converted path, including the nul */
+  n = MultiByteToWideChar(
+        CP_UTF8, MB_ERR_INVALID_CHARS, pPath, -1, NULL, 0);
+  
+  /* Allocate and convert the path */
+  if (n > 0) {
+    pResult = (wchar_t *) calloc((size_t) n, sizeof(wchar_t));
+    if (pResult == NULL) {
+      fault(__LINE__);
+    }
+    if (MultiByteToWideChar(
+          CP_UTF8, MB_ERR_INVALID_CHARS, pPath, -1, pResult, n) != n) {
+      free(pResult);
+      pResult = NULL;
+    }
+  }
+  
+  /* Return result or NULL */
+  return pResult;
+}
+#endif
+
+/*
+ * Check whether a file exists.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ * Return:
+ * 
+ *   non-zero if the file exists, zero if it does not or can not be
+ *   found
+ */
+static int fileExists(const char *pPath) {
+  
+  int result = 0;
+#ifdef AKS_WIN
+  wchar_t *pw = NULL;
+#else
+  struct stat st;
+#endif
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Look up the file */
+#ifdef AKS_WIN
+  pw = widePath(pPath);
+  if (pw != NULL) {
+    if (GetFileAttributesW(pw) != INVALID_FILE_ATTRIBUTES) {
+      result = 1;
+    }
+  }
+  free(pw);
+#else
+  if (stat(pPath, &st) == 0) {
+    result = 1;
+  }
+#endif
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Get the current length of a file without opening a view of it.
+ * 
+ * This is much cheaper than opening a view, so it is used to poll a
+ * followed file for growth.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ * Return:
+ * 
+ *   the length of the file, or -1 if it can not be found
+ */
+static int64_t fileLength(const char *pPath) {
+  
+  int64_t result = -1;
+#ifdef AKS_WIN
+  wchar_t *pw = NULL;
+  WIN32_FILE_ATTRIBUTE_DATA fad;
+#else
+  struct stat st;
+#endif
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Look up the file */
+#ifdef AKS_WIN
+  pw = widePath(pPath);
+  if (pw != NULL) {
+    if (GetFileAttributesExW(pw, GetFileExInfoStandard, &fad)) {
+      result = (int64_t) ((((uint64_t) fad.nFileSizeHigh) << 32) |
+                            ((uint64_t) fad.nFileSizeLow));
+    }
+  }
+  free(pw);
+#else
+  if (stat(pPath, &st) == 0) {
+    result = (int64_t) st.st_size;
+  }
+#endif
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Check whether two paths refer to the same file.
+ * 
+ * The files are compared by their identity rather than their paths, so
+ * that links and different spellings of the same path are found.  On
+ * POSIX this is the device and inode number, and on Windows the volume
+ * serial number and file index.
+ * 
+ * Parameters:
+ * 
+ *   pPathA - the path to the first file
+ * 
+ *   pPathB - the path to the second file
+ * 
+ * Return:
+ * 
+ *   non-zero if both paths refer to the same existing file, zero if
+ *   they do not or if either can not be found
+ */
+static int sameFile(const char *pPathA, const char *pPathB) {
+  
+  int result = 0;
+#ifdef AKS_WIN
+  int i = 0;
+  wchar_t *pw = NULL;
+  HANDLE h[2];
+  BY_HANDLE_FILE_INFORMATION fi[2];
+#else
+  struct stat sa;
+  struct stat sb;
+#endif
+  
+  /* Check parameters */
+  if ((pPathA == NULL) || (pPathB == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Look up both files and compare their identities */
+#ifdef AKS_WIN
+  for(i = 0; i < 2; i++) {
+    h[i] = INVALID_HANDLE_VALUE;
+    pw = widePath((i == 0) ? pPathA : pPathB);
+    if (pw != NULL) {
+      h[i] = CreateFileW(pw, 0,
+                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    }
+    free(pw);
+    if (h[i] != INVALID_HANDLE_VALUE) {
+      if (!GetFileInformationByHandle(h[i], &(fi[i]))) {
+        CloseHandle(h[i]);
+        h[i] = INVALID_HANDLE_VALUE;
+      }
+    }
+  }
+  
+  if ((h[0] != INVALID_HANDLE_VALUE) && (h[1] != INVALID_HANDLE_VALUE)) {
+    if ((fi[0].dwVolumeSerialNumber == fi[1].dwVolumeSerialNumber) &&
+        (fi[0].nFileIndexHigh == fi[1].nFileIndexHigh) &&
+        (fi[0].nFileIndexLow == fi[1].nFileIndexLow)) {
+      result = 1;
+    }
+  }
+  
+  for(i = 0; i < 2; i++) {
+    if (h[i] != INVALID_HANDLE_VALUE) {
+      CloseHandle(h[i]);
+    }
+  }
+#else
+  if ((stat(pPathA, &sa) == 0) && (stat(pPathB, &sb) == 0)) {
+    if ((sa.st_dev == sb.st_dev) && (sa.st_ino == sb.st_ino)) {
+      result = 1;
+    }
+  }
+#endif
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Flush the data of a file through to the storage device.
+ * 
+ * libaksview has no call for this, so the file is opened again on a
+ * separate descriptor, which is synchronized and closed.  Every view
+ * that wrote to the file must already be closed, so that the written
+ * data has been handed to the operating system.
+ * 
+ * Errors are reported to stderr.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int syncFile(const char *pPath) {
+  
+  int status = 1;
+#ifdef AKS_WIN
+  wchar_t *pw = NULL;
+  HANDLE h = INVALID_HANDLE_VALUE;
+#else
+  int fd = -1;
+#endif
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Open the file, flush it, and close it */
+#ifdef AKS_WIN
+  pw = widePath(pPath);
+  if (pw != NULL) {
+    h = CreateFileW(
+          pw,
+          GENERIC_WRITE,
+          FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+          NULL,
+          OPEN_EXISTING,
+          FILE_ATTRIBUTE_NORMAL,
+          NULL);
+  }
+  if ((h == INVALID_HANDLE_VALUE) || (!FlushFileBuffers(h))) {
+    status = 0;
+  }
+  if (h != INVALID_HANDLE_VALUE) {
+    CloseHandle(h);
+  }
+  free(pw);
+#else
+  fd = open(pPath, O_RDWR);
+  if ((fd < 0) || (fsync(fd) != 0)) {
+    status = 0;
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+#endif
+  
+  if (!status) {
+    fprintf(stderr, "%s: Failed to flush file to disk: %s\n",
+              pModule, pPath);
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Flush the directory that holds a file through to the storage device,
+ * so that a newly created file is still there after a crash.
+ * 
+ * This only does anything on POSIX platforms.  On Windows, the file
+ * system records directory changes itself.  A file system that can not
+ * synchronize directories is not treated as an error.
+ * 
+ * Errors are reported to stderr.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int syncParent(const char *pPath) {
+  
+  int status = 1;
+#ifndef AKS_WIN
+  char *pDir = NULL;
+  char *pSlash = NULL;
+  int fd = -1;
+#endif
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+#ifndef AKS_WIN
+  /* Get the path of the directory, which is everything before the last
+   * slash, or the current directory if there is no slash */
+  pDir = (char *) malloc(strlen(pPath) + 2);
+  if (pDir == NULL) {
+    fault(__LINE__);
+  }
+  strcpy(pDir, pPath);
+  pSlash = strrchr(pDir, '/');
+  if (pSlash == NULL) {
+    strcpy(pDir, ".");
+  } else if (pSlash == pDir) {
+    pDir[1] = 0;
+  } else {
+    *pSlash = 0;
+  }
+  
+  /* Open the directory, flush it, and close it */
+  fd = open(pDir, O_RDONLY);
+  if (fd < 0) {
+    status = 0;
+  } else if (fsync(fd) != 0) {
+    if (errno != EINVAL) {
+      status = 0;
+    }
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+  
+  if (!status) {
+    fprintf(stderr, "%s: Failed to flush directory to disk: %s\n",
+              pModule, pDir);
+  }
+  free(pDir);
+#endif
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Give the buffer pool a memory budget.
+ * 
+ * The whole budget is allocated straight away, so that running out of
+ * memory is found before any file is touched.  This may only be called
+ * once, before any buffer has been taken.
+ * 
+ * Errors are reported to stderr.
+ * 
+ * Parameters:
+ * 
+ *   cap - the budget in bytes, which is rounded up to a multiple of
+ *   POOL_ALIGN
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int poolInit(int64_t cap) {
+  
+  int status = 1;
+  uintptr_t a = 0;
+  
+  /* Check state and parameter */
+  if ((bufPool.cap >= 0) || (bufPool.count > 0) || (cap < 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Round up the budget */
+  if (cap > INT64_MAX - POOL_ALIGN) {
+    cap = INT64_MAX - POOL_ALIGN;
+  }
+  cap = ((cap + POOL_ALIGN - 1) / POOL_ALIGN) * POOL_ALIGN;
+  
+  /* Check the budget against its limits */
+  if (cap < POOL_MINCAP) {
+    status = 0;
+    fprintf(stderr, "%s: Memory budget is too small!\n", pModule);
+  }
+  if (status && ((uint64_t) (cap + POOL_ALIGN) > (uint64_t) SIZE_MAX)) {
+    status = 0;
+    fprintf(stderr, "%s: Memory budget is too large!\n", pModule);
+  }
+  
+  /* Allocate the pool with room to align its start */
+  if (status) {
+    bufPool.pAlloc = malloc((size_t) (cap + POOL_ALIGN));
+    if (bufPool.pAlloc == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to allocate memory budget!\n",
+                pModule);
+    }
+  }
+  if (status) {
+    a = (uintptr_t) bufPool.pAlloc;
+    a = (a + (uintptr_t) (POOL_ALIGN - 1)) &
+          ~((uintptr_t) (POOL_ALIGN - 1));
+    bufPool.pBase = (uint8_t *) a;
+    bufPool.cap = cap;
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Print the statistics of the buffer pool to stderr.
+ */
+static void poolStats(void) {
+  
+  /* Flush standard output first, so the statistics come after it */
+  fflush(stdout);
+  
+  /* Print the statistics */
+  fprintf(stderr, "%s: Buffer memory peak: %lld bytes; buffers taken: "
+            "%lld; ", pModule,
+            (long long) bufPool.peak, (long long) bufPool.takes);
+  if (bufPool.cap >= 0) {
+    fprintf(stderr, "budget: %lld bytes\n", (long long) bufPool.cap);
+  } else {
+    fprintf(stderr, "budget: none\n");
+  }
+}
+
+/*
+ * Release the memory of the buffer pool.
+ * 
+ * All buffers must have been released first.
+ */
+static void poolRelease(void) {
+  
+  /* Check state */
+  if (bufPool.count > 0) {
+    fault(__LINE__);
+  }
+  
+  /* Release the pool */
+  free(bufPool.pAlloc);
+  bufPool.pAlloc = NULL;
+  bufPool.pBase = NULL;
+  bufPool.cap = -1;
+}
+
+/*
+ * Take a buffer from the buffer pool.
+ * 
+ * Without a memory budget, the buffer is allocated from the heap and a
+ * failed allocation is a fault.  With a budget, the buffer is carved
+ * from the pool, and if the budget does not leave room for it, an error
+ * is reported to stderr.
+ * 
+ * The buffer is aligned to POOL_ALIGN when there is a budget.  It must
+ * be released with bufFree().
+ * 
+ * Parameters:
+ * 
+ *   len - the length of the buffer in bytes, which must be at least one
+ * 
+ * Return:
+ * 
+ *   the buffer, or NULL if the memory budget is exceeded
+ */
+static void *bufAlloc(int64_t len) {
+  
+  uint8_t *pResult = NULL;
+  int64_t base = 0;
+  
+  /* Check parameter and state */
+  if ((len < 1) || ((uint64_t) len > (uint64_t) SIZE_MAX) ||
+      (bufPool.count >= POOL_MAXBUF)) {
+    fault(__LINE__);
+  }
+  
+  if (bufPool.cap < 0) {
+    /* No budget, so just allocate the buffer */
+    pResult = (uint8_t *) malloc((size_t) len);
+    if (pResult == NULL) {
+      fault(__LINE__);
+    }
+    bufPool.used += len;
+  
+  } else {
+    /* Carve the buffer from just above the last buffer in use */
+    base = bufPool.used;
+    if (len <= bufPool.cap - base) {
+      len = ((len + POOL_ALIGN - 1) / POOL_ALIGN) * POOL_ALIGN;
+      pResult = bufPool.pBase + base;
+      bufPool.used = base + len;
+    } else {
+      fprintf(stderr, "%s: Memory budget exceeded!\n", pModule);
+    }
+  }
+  
+  /* Record the buffer and update the statistics */
+  if (pResult != NULL) {
+    bufPool.pBuf[bufPool.count] = pResult;
+    bufPool.size[bufPool.count] = len;
+    bufPool.count++;
+    bufPool.takes++;
+    if (bufPool.used > bufPool.peak) {
+      bufPool.peak = bufPool.used;
+    }
+  }
+  
+  /* Return result */
+  return (void *) pResult;
+}
+
+/*
+ * Release a buffer taken with bufAlloc().
+ * 
+ * With a memory budget, the space of a buffer only becomes free again
+ * once every buffer taken after it has also been released.
+ * 
+ * Parameters:
+ * 
+ *   p - the buffer, or NULL to do nothing
+ */
+static void bufFree(void *p) {
+  
+  int i = 0;
+  
+  /* Find the buffer if one was given */
+  if (p != NULL) {
+    for(i = 0; i < bufPool.count; i++) {
+      if (bufPool.pBuf[i] == (uint8_t *) p) {
+        break;
+      }
+    }
+    if (i >= bufPool.count) {
+      fault(__LINE__);
+    }
+  
+    /* Release the buffer and remove it from the table */
+    if (bufPool.cap < 0) {
+      free(p);
+      bufPool.used -= bufPool.size[i];
+    }
+    for( ; i < bufPool.count - 1; i++) {
+      bufPool.pBuf[i] = bufPool.pBuf[i + 1];
+      bufPool.size[i] = bufPool.size[i + 1];
+    }
+    bufPool.count--;
+  
+    /* With a budget, the pool is used up to the end of the last buffer
+     * still in use */
+    if (bufPool.cap >= 0) {
+      if (bufPool.count > 0) {
+        i = bufPool.count - 1;
+        bufPool.used = (int64_t) (bufPool.pBuf[i] - bufPool.pBase) +
+                          bufPool.size[i];
+      } else {
+        bufPool.used = 0;
+      }
+    }
+  }
+}
+
+/*
+ * Change the length of a buffer taken with bufAlloc(), keeping its
+ * contents up to the shorter of the two lengths.  If no buffer is given,
+ * this is the same as bufAlloc().
+ * 
+ * Without a memory budget, the buffer is reallocated from the heap and
+ * a failed allocation is a fault.  With a budget, the last buffer taken
+ * grows in place if the budget leaves room.  Any other buffer is moved
+ * to a new buffer carved above the last one, and its old space only
+ * becomes free again in the same way as with bufFree().  If the budget
+ * does not leave room, an error is reported to stderr and the buffer is
+ * left as it was.
+ * 
+ * Parameters:
+ * 
+ *   p - the buffer, or NULL to take a new one
+ * 
+ *   len - the new length of the buffer in bytes, which must be at least
+ *   one
+ * 
+ * Return:
+ * 
+ *   the buffer, which may have moved, or NULL if the memory budget is
+ *   exceeded
+ */
+static void *bufGrow(void *p, int64_t len) {
+  
+  int i = 0;
+  uint8_t *pResult = NULL;
+  int64_t base = 0;
+  
+  /* Check parameter */
+  if ((len < 1) || ((uint64_t) len > (uint64_t) SIZE_MAX)) {
+    fault(__LINE__);
+  }
+  
+  /* Find the buffer if one was given */
+  if (p != NULL) {
+    for(i = 0; i < bufPool.count; i++) {
+      if (bufPool.pBuf[i] == (uint8_t *) p) {
+        break;
+      }
+    }
+    if (i >= bufPool.count) {
+      fault(__LINE__);
+    }
+  }
+  
+  if (p == NULL) {
+    /* No buffer, so take a new one */
+    pResult = (uint8_t *) bufAlloc(len);
+    
+  } else if (bufPool.cap < 0) {
+    /* No budget, so just reallocate the buffer */
+    pResult = (uint8_t *) realloc(p, (size_t) len);
+    if (pResult == NULL) {
+      fault(__LINE__);
+    }
+    bufPool.used += len - bufPool.size[i];
+    bufPool.pBuf[i] = pResult;
+    bufPool.size[i] = len;
+    
+  } else if (i == bufPool.count - 1) {
+    /* Last buffer, so grow or shrink it in place */
+    base = (int64_t) (bufPool.pBuf[i] - bufPool.pBase);
+    if (len <= bufPool.cap - base) {
+      len = ((len + POOL_ALIGN - 1) / POOL_ALIGN) * POOL_ALIGN;
+      pResult = (uint8_t *) p;
+      bufPool.size[i] = len;
+      bufPool.used = base + len;
+    } else {
+      fprintf(stderr, "%s: Memory budget exceeded!\n", pModule);
+    }
+    
+  } else {
+    /* Move the buffer above the last one and release its old space */
+    pResult = (uint8_t *) bufAlloc(len);
+    if (pResult != NULL) {
+      if (len > bufPool.size[i]) {
+        len = bufPool.size[i];
+      }
+      memcpy(pResult, p, (size_t) len);
+      bufFree(p);
+    }
+  }
+  
+  /* Update the statistics */
+  if (bufPool.used > bufPool.peak) {
+    bufPool.peak = bufPool.used;
+  }
+  
+  /* Return result */
+  return (void *) pResult;
+}
+
+/*
+ * Get the number of bytes that bufAlloc() could still take, so that
+ * optional buffers can be left out rather than exceed the budget.
+ * 
+ * Return:
+ * 
+ *   the number of bytes left in the budget, zero if no more buffers may
+ *   be taken, or -1 if there is no budget
+ */
+static int64_t bufRoom(void) {
+  
+  int64_t result = 0;
+  
+  /* Find the room above the last buffer in use */
+  if (bufPool.count >= POOL_MAXBUF) {
+    result = 0;
+  } else if (bufPool.cap < 0) {
+    result = -1;
+  } else {
+    result = bufPool.cap - bufPool.used;
+  }
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Lock a byte range of a file against other processes.
+ * 
+ * Locks are only taken when compiled with BINPOKE_LOCK.  Otherwise,
+ * this function always succeeds without doing anything.  The locks are
+ * open file description locks on a separate descriptor, so they are not
+ * affected by views of the file being opened and closed.  They are held
+ * until lockRelease() is called.
+ * 
+ * Since each range lock has its own descriptor, two range locks on the
+ * same file conflict with each other even within one process.  A verb
+ * that takes two range locks on paths that may be the same file must
+ * check with sameFile() first.
+ * 
+ * Errors are reported to stderr.
+ * 
+ * Parameters:
+ * 
+ *   pk - the range lock, which may already hold other ranges of the
+ *   same file and the same kind
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pos - the file offset of the first byte of the range
+ * 
+ *   len - the number of bytes in the range, which may be zero to lock
+ *   nothing, or LOCK_TO_END to lock everything from pos onwards,
+ *   including any bytes later appended
+ * 
+ *   excl - non-zero for an exclusive lock for writing, zero for a
+ *   shared lock for reading
+ * 
+ *   wait - non-zero to wait until the range is free, zero to fail if
+ *   any part of it is locked by another process
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int lockRange(
+    RANGE_LOCK *pk,
+    const char *pPath,
+    int64_t pos,
+    int64_t len,
+    int excl,
+    int wait) {
+  
+  int status = 1;
+#ifdef BINPOKE_LOCK
+  int cmd = 0;
+  struct flock fl;
+#endif
+  
+  /* Check parameters */
+  if ((pk == NULL) || (pPath == NULL) || (pos < 0) ||
+      ((len < 0) && (len != LOCK_TO_END))) {
+    fault(__LINE__);
+  }
+  
+#ifdef BINPOKE_LOCK
+  /* Open the descriptor for the locks, unless it is already open; a
+   * descriptor for an exclusive lock must be open for writing */
+  if ((len != 0) && (pk->fd < 0)) {
+    if (excl) {
+      pk->fd = open(pPath, O_RDWR);
+    } else {
+      pk->fd = open(pPath, O_RDONLY);
+    }
+    if (pk->fd < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file for locking!\n",
+                pModule);
+    }
+  }
+  
+  /* Take the lock */
+  if (status && (len != 0)) {
+    memset(&fl, 0, sizeof(struct flock));
+    if (excl) {
+      fl.l_type = F_WRLCK;
+    } else {
+      fl.l_type = F_RDLCK;
+    }
+    fl.l_whence = SEEK_SET;
+    fl.l_start = (off_t) pos;
+    if (len != LOCK_TO_END) {
+      fl.l_len = (off_t) len;
+    }
+    
+    if (wait) {
+      cmd = F_OFD_SETLKW;
+    } else {
+      cmd = F_OFD_SETLK;
+    }
+    
+    if (fcntl(pk->fd, cmd, &fl) == -1) {
+      status = 0;
+      if ((errno == EAGAIN) || (errno == EACCES)) {
+        fprintf(stderr, "%s: Byte range is locked by another process!\n",
+                  pModule);
+      } else {
+        fprintf(stderr, "%s: Failed to lock byte range!\n", pModule);
+      }
+    }
+  }
+#else
+  (void) excl;
+  (void) wait;
+#endif
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Release all the byte ranges held by a range lock.
+ * 
+ * The structure is reset.  Does nothing if no ranges are held.
+ * 
+ * Parameters:
+ * 
+ *   pk - the range lock
+ */
+static void lockRelease(RANGE_LOCK *pk) {
+  
+  /* Check parameter */
+  if (pk == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Closing the descriptor releases all its locks */
+#ifdef BINPOKE_LOCK
+  if (pk->fd >= 0) {
+    close(pk->fd);
+  }
+#endif
+  pk->fd = -1;
+}
+
+/*
+ * Open a cache dropper, which drops the cached pages of a file behind a
+ * scan.
+ * 
+ * This is only a hint to the operating system.  It does nothing unless
+ * compiled with BINPOKE_FADVISE, and any failure simply disables it.
+ * 
+ * Dropping pages works through any descriptor of the file, because the
+ * page cache belongs to the file itself.  The sequential and random
+ * read-ahead hints are not given, since on Linux they only change the
+ * read-ahead of the descriptor they are given on, and the reads of the
+ * scan go through the descriptor of libaksview, which is not exposed.
+ * 
+ * The structure must be released with cacheClose(), whether or not it
+ * is enabled.
+ * 
+ * Parameters:
+ * 
+ *   pc - the cache dropper to open
+ * 
+ *   pPath - the path to the file
+ * 
+ *   enable - non-zero to enable the dropper, zero to open it disabled
+ */
+static void cacheOpen(CACHE_DROP *pc, const char *pPath, int enable) {
+  
+  /* Check parameters */
+  if ((pc == NULL) || (pPath == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Reset structure, and open a separate descriptor for the hints */
+  memset(pc, 0, sizeof(CACHE_DROP));
+  pc->fd = -1;
+#ifdef BINPOKE_FADVISE
+  if (enable) {
+    pc->fd = open(pPath, O_RDONLY);
+  }
+#else
+  (void) enable;
+#endif
+}
+
+/*
+ * Record that a range of a file has been scanned, and drop the cached
+ * pages of scanned ranges once they add up to CACHE_SPAN bytes.
+ * 
+ * Contiguous ranges are merged.  Does nothing if the cache dropper is
+ * not open.
+ * 
+ * Parameters:
+ * 
+ *   pc - the cache dropper
+ * 
+ *   pos - the file offset of the range
+ * 
+ *   len - the length of the range
+ */
+static void cacheDrop(CACHE_DROP *pc, int64_t pos, int64_t len) {
+  
+  /* Check parameters */
+  if ((pc == NULL) || (pos < 0) || (len < 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Issue the pending range if this one does not extend it, or if it
+   * is long enough */
+  if ((pc->len > 0) && (pos != pc->pos + pc->len)) {
+    cacheFlush(pc);
+  }
+  if (pc->len < 1) {
+    pc->pos = pos;
+  }
+  pc->len += len;
+  if (pc->len >= CACHE_SPAN) {
+    cacheFlush(pc);
+  }
+}
+
+/*
+ * Drop the cached pages of the pending range of a cache dropper, and
+ * empty the pending range.
+ * 
+ * Parameters:
+ * 
+ *   pc - the cache dropper
+ */
+static void cacheFlush(CACHE_DROP *pc) {
+  
+  /* Check parameter */
+  if (pc == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Issue the hint */
+#ifdef BINPOKE_FADVISE
+  if ((pc->fd >= 0) && (pc->len > 0)) {
+    posix_fadvise(pc->fd, (off_t) pc->pos, (off_t) pc->len,
+                  POSIX_FADV_DONTNEED);
+  }
+#endif
+  pc->len = 0;
+}
+
+/*
+ * Drop any pending range of a cache dropper and release it.
+ * 
+ * The structure is reset.  Call this after the views of the file have
+ * been closed, so that written pages have been handed to the operating
+ * system.
+ * 
+ * Parameters:
+ * 
+ *   pc - the cache dropper
+ */
+static void cacheClose(CACHE_DROP *pc) {
+  
+  /* Check parameter */
+  if (pc == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Drop the pending range and close the descriptor */
+  cacheFlush(pc);
+#ifdef BINPOKE_FADVISE
+  if (pc->fd >= 0) {
+    close(pc->fd);
+  }
+#endif
+  memset(pc, 0, sizeof(CACHE_DROP));
+  pc->fd = -1;
+}
+
+/*
+ * Open a hole map, which finds the holes of a sparse file so that a
+ * scan can skip reading them.
+ * 
+ * Holes are only found when compiled with BINPOKE_SPARSE.  Otherwise,
+ * and if anything fails, the hole map is disabled and simply never
+ * finds a hole.
+ * 
+ * The structure must be released with holeClose(), whether or not it
+ * is enabled.
+ * 
+ * Parameters:
+ * 
+ *   ph - the hole map to open
+ * 
+ *   pPath - the path to the file
+ */
+static void holeOpen(HOLE_MAP *ph, const char *pPath) {
+  
+  /* Check parameters */
+  if ((ph == NULL) || (pPath == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Reset structure, and open a separate descriptor for finding
+   * holes */
+  memset(ph, 0, sizeof(HOLE_MAP));
+  ph->fd = -1;
+#ifdef BINPOKE_SPARSE
+  ph->fd = open(pPath, O_RDONLY);
+#endif
+}
+
+/*
+ * Check whether a range of a file lies entirely within a hole, so that
+ * it is known to read as zero bytes.
+ * 
+ * The most recently found hole is remembered, so a scan through a large
+ * hole only asks the operating system once.  The caller must ensure
+ * that the range is within the file limits.
+ * 
+ * Parameters:
+ * 
+ *   ph - the hole map
+ * 
+ *   pos - the file offset of the range
+ * 
+ *   len - the length of the range, which must be at least one
+ * 
+ * Return:
+ * 
+ *   non-zero if the range is known to be a hole, zero otherwise
+ */
+static int holeCheck(HOLE_MAP *ph, int64_t pos, int64_t len) {
+  
+  int result = 0;
+#ifdef BINPOKE_SPARSE
+  off_t d = 0;
+#endif
+  
+  /* Check parameters */
+  if ((ph == NULL) || (pos < 0) || (len < 1)) {
+    fault(__LINE__);
+  }
+  
+  /* Check against the remembered hole, and otherwise look for the next
+   * data at or after the range; if there is none, the rest of the file
+   * is a hole, and if the lookup fails for any other reason, the hole
+   * map is disabled */
+  if (ph->fd >= 0) {
+    if ((pos >= ph->pos) && (pos < ph->end) && (len <= ph->end - pos)) {
+      result = 1;
+      
+    } else {
+#ifdef BINPOKE_SPARSE
+      d = lseek(ph->fd, (off_t) pos, SEEK_DATA);
+      if (d < 0) {
+        if (errno == ENXIO) {
+          ph->pos = pos;
+          ph->end = INT64_MAX;
+          result = 1;
+        } else {
+          close(ph->fd);
+          ph->fd = -1;
+        }
+        
+      } else if ((int64_t) d - pos >= len) {
+        ph->pos = pos;
+        ph->end = (int64_t) d;
+        result = 1;
+      }
+#endif
+    }
+  }
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Release a hole map.
+ * 
+ * The structure is reset.
+ * 
+ * Parameters:
+ * 
+ *   ph - the hole map
+ */
+static void holeClose(HOLE_MAP *ph) {
+  
+  /* Check parameter */
+  if (ph == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Close the descriptor */
+#ifdef BINPOKE_SPARSE
+  if (ph->fd >= 0) {
+    close(ph->fd);
+  }
+#endif
+  memset(ph, 0, sizeof(HOLE_MAP));
+  ph->fd = -1;
+}
+
+/*
+ * Open a watch on a followed file.
+ * 
+ * The file is only watched when compiled with BINPOKE_INOTIFY.
+ * Otherwise, and if anything fails, the watch is disabled and waiting
+ * on it simply sleeps.
+ * 
+ * The structure must be released with watchClose(), whether or not it
+ * is enabled.
+ * 
+ * Parameters:
+ * 
+ *   pw - the watch to open
+ * 
+ *   pPath - the path to the file
+ */
+static void watchOpen(FILE_WATCH *pw, const char *pPath) {
+  
+  /* Check parameters */
+  if ((pw == NULL) || (pPath == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Reset structure, and watch the file for writes and truncation */
+  memset(pw, 0, sizeof(FILE_WATCH));
+  pw->fd = -1;
+#ifdef BINPOKE_INOTIFY
+  pw->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (pw->fd >= 0) {
+    if (inotify_add_watch(pw->fd, pPath, IN_MODIFY | IN_ATTRIB) < 0) {
+      close(pw->fd);
+      pw->fd = -1;
+    }
+  }
+#endif
+}
+
+/*
+ * Wait for a followed file to change.
+ * 
+ * If the watch is enabled, this returns as soon as the file is written,
+ * or when the delay runs out, whichever comes first.  Otherwise, it
+ * sleeps for the whole delay.  Either way, the caller must check the
+ * file length afterwards, since a wakeup does not mean the file grew.
+ * 
+ * Parameters:
+ * 
+ *   pw - the watch
+ * 
+ *   ms - the longest delay in milliseconds, which must be in range
+ *   [0, 999999]
+ */
+static void watchWait(FILE_WATCH *pw, int32_t ms) {
+  
+#ifdef BINPOKE_INOTIFY
+  struct pollfd pfd;
+  char buf[4096];
+#endif
+  
+  /* Check parameters */
+  if ((pw == NULL) || (ms < 0) || (ms > INT32_C(999999))) {
+    fault(__LINE__);
+  }
+  
+  /* Wait on the watch if enabled, then drain its events; if polling
+   * fails for any other reason than a signal, the watch is disabled */
+  if (pw->fd >= 0) {
+#ifdef BINPOKE_INOTIFY
+    memset(&pfd, 0, sizeof(struct pollfd));
+    pfd.fd = pw->fd;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, (int) ms) < 0) {
+      if (errno != EINTR) {
+        close(pw->fd);
+        pw->fd = -1;
+      }
+    } else {
+      while (read(pw->fd, buf, sizeof(buf)) > 0);
+    }
+#endif
+  } else {
+    pauseMillis(ms);
+  }
+}
+
+/*
+ * Release a watch on a followed file.
+ * 
+ * The structure is reset.
+ * 
+ * Parameters:
+ * 
+ *   pw - the watch
+ */
+static void watchClose(FILE_WATCH *pw) {
+  
+  /* Check parameter */
+  if (pw == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Close the descriptor */
+#ifdef BINPOKE_INOTIFY
+  if (pw->fd >= 0) {
+    close(pw->fd);
+  }
+#endif
+  memset(pw, 0, sizeof(FILE_WATCH));
+  pw->fd = -1;
+}
+
+/*
+ * Release all resources held by an edit session.
+ * 
+ * The view of the original file is closed if open, and the structure is
+ * reset to empty.  Does nothing to a session that is already empty.
+ * 
+ * Parameters:
+ * 
+ *   pe - the edit session
+ */
+static void sessionFree(EDIT_SESSION *pe) {
+  
+  /* Check parameter */
+  if (pe == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Release resources and reset structure */
+  aksview_close(pe->pv);
+  bufFree(pe->pPiece);
+  bufFree(pe->pAdd);
+  memset(pe, 0, sizeof(EDIT_SESSION));
+}
+
+/*
+ * Load an open edit session for a file.
+ * 
+ * The original file is opened in the given aksview mode and its view
+ * is stored in the session.  Then the piece table and add-buffer are
+ * loaded from the session file.  Errors are reported to stderr.
+ * 
+ * The session structure must be empty when this function is called.
+ * On return, it must be released with sessionFree() whether or not
+ * loading succeeded.
+ * 
+ * Parameters:
+ * 
+ *   pe - the edit session to load into
+ * 
+ *   pPath - the path to the original file
+ * 
+ *   vmode - the aksview mode to open the original file with
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int sessionLoad(EDIT_SESSION *pe, const char *pPath, int vmode) {
+  
+  int status = 1;
+  int errcode = 0;
+  AKSVIEW *ps = NULL;
+  char *pSPath = NULL;
+  
+  int j = 0;
+  int64_t slen = 0;
+  int64_t pos = 0;
+  int64_t x = 0;
+  int64_t total = 0;
+  int32_t blen = 0;
+  uint64_t piece_count = 0;
+  uint64_t add_len = 0;
+  PIECE *pp = NULL;
+  
+  /* Check parameters */
+  if ((pe == NULL) || (pPath == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Open the original file */
+  pe->pv = aksview_create(pPath, vmode, &errcode);
+  if (pe->pv == NULL) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to open file: %s\n",
+              pModule, aksview_errstr(errcode));
+  }
+  
+  /* Open the session file */
+  if (status) {
+    pSPath = sidecarPath(pPath, SESSION_SUFFIX);
+    ps = aksview_create(pSPath, AKSVIEW_READONLY, &errcode);
+    if (ps == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open edit session: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
+  }
+  
+  /* Check the signature */
+  if (status) {
+    slen = aksview_getlen(ps);
+    if (slen < SESSION_HEADER) {
+      status = 0;
+    }
+    for(j = 0; status && (j < 8); j++) {
+      if (aksview_read8u(ps, j) != (SESSION_SIGNATURE)[j]) {
+        status = 0;
+      }
+    }
+    if (!status) {
+      fprintf(stderr, "%s: No edit session is open for file!\n",
+                pModule);
+    }
+  }
+  
+  /* Read the rest of the header and check the sizes are consistent */
+  if (status) {
+    pe->orig_len = (int64_t) readInt(ps, 8, pSidecarType);
+    piece_count = readInt(ps, 16, pSidecarType);
+    add_len = readInt(ps, 24, pSidecarType);
+    
+    if ((piece_count > (uint64_t) SESSION_MAXPIECES) ||
+        (add_len > (uint64_t) (slen - SESSION_HEADER)) ||
+        ((uint64_t) (slen - SESSION_HEADER) !=
+            piece_count * SESSION_PIECE + add_len)) {
+      status = 0;
+      fprintf(stderr, "%s: Edit session file is corrupt!\n", pModule);
+    }
+  }
+  
+  /* Make sure the original file has not been resized since the session
+   * was opened */
+  if (status && (pe->orig_len != aksview_getlen(pe->pv))) {
+    status = 0;
+    fprintf(stderr, "%s: File was resized outside the edit session!\n",
+              pModule);
+  }
+  
+  /* Take the piece table and add-buffer from the buffer pool, with room
+   * to grow */
+  if (status) {
+    pe->piece_count = (int32_t) piece_count;
+    pe->piece_cap = pe->piece_count + 64;
+    pe->pPiece = (PIECE *) bufAlloc(
+                    ((int64_t) pe->piece_cap) * ((int64_t) sizeof(PIECE)));
+    if (pe->pPiece == NULL) {
+      status = 0;
+    }
+  }
+  if (status) {
+    pe->add_len = (int64_t) add_len;
+    pe->add_cap = pe->add_len + SESSION_ADDROOM;
+    pe->pAdd = (uint8_t *) bufAlloc(pe->add_cap);
+    if (pe->pAdd == NULL) {
+      status = 0;
+    }
+  }
+  
+  /* Read the pieces, checking that each refers to valid data */
+  if (status) {
+    pos = SESSION_HEADER;
+    for(x = 0; x < pe->piece_count; x++) {
+      pp = &((pe->pPiece)[x]);
+      pp->kind = (int) aksview_read8u(ps, pos);
+      pp->src = (int64_t) readInt(ps, pos + 1, pSidecarType);
+      pp->len = (int64_t) readInt(ps, pos + 9, pSidecarType);
+      pos += SESSION_PIECE;
+      
+      if ((pp->src < 0) || (pp->len < 1) ||
+          (pp->len > AKSVIEW_MAXLEN - total)) {
+        status = 0;
+      } else if (pp->kind == PIECE_ORIG) {
+        if (pp->src > pe->orig_len - pp->len) {
+          status = 0;
+        }
+      } else if (pp->kind == PIECE_ADD) {
+        if (pp->src > pe->add_len - pp->len) {
+          status = 0;
+        }
+      } else if (pp->kind != PIECE_ZERO) {
+        status = 0;
+      }
+      
+      if (!status) {
+        fprintf(stderr, "%s: Edit session file is corrupt!\n", pModule);
+        break;
+      }
+      total += pp->len;
+    }
+    pe->len = total;
+  }
+  
+  /* Read the add-buffer */
+  if (status) {
+    for(x = 0; x < pe->add_len; x += blen) {
+      if (pe->add_len - x < BLOCK_SIZE) {
+        blen = (int32_t) (pe->add_len - x);
+      } else {
+        blen = BLOCK_SIZE;
+      }
+      readBlock(ps, pos + x, pe->pAdd + x, blen);
+    }
+  }
+  
+  /* Close session file and release path */
+  aksview_close(ps);
+  free(pSPath);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Save the piece table and add-buffer of an edit session to the
+ * session file.
+ * 
+ * Errors are reported to stderr.
+ * 
+ * Parameters:
+ * 
+ *   pe - the edit session
+ * 
+ *   pPath - the path to the original file
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int sessionSave(const EDIT_SESSION *pe, const char *pPath) {
+  
+  int status = 1;
+  int errcode = 0;
+  AKSVIEW *ps = NULL;
+  char *pSPath = NULL;
+  
+  int j = 0;
+  int64_t pos = 0;
+  int64_t x = 0;
+  int32_t blen = 0;
+  const PIECE *pp = NULL;
+  
+  /* Check parameters */
+  if ((pe == NULL) || (pPath == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Open the session file */
+  pSPath = sidecarPath(pPath, SESSION_SUFFIX);
+  ps = aksview_create(pSPath, AKSVIEW_EXISTING, &errcode);
+  if (ps == NULL) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to open edit session: %s\n",
+              pModule, aksview_errstr(errcode));
+  }
+  
+  /* Set the new length of the session file */
+  if (status) {
+    if (!aksview_setlen(ps, SESSION_HEADER +
+              (((int64_t) pe->piece_count) * SESSION_PIECE) +
+              pe->add_len)) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to set length on edit session!\n",
+                pModule);
+    }
+  }
+  
+  /* Write the header, the pieces, and the add-buffer */
+  if (status) {
+    for(j = 0; j < 8; j++) {
+      aksview_write8(ps, j, (SESSION_SIGNATURE)[j]);
+    }
+    writeInt(ps, 8, pSidecarType, (uint64_t) pe->orig_len);
+    writeInt(ps, 16, pSidecarType, (uint64_t) pe->piece_count);
+    writeInt(ps, 24, pSidecarType, (uint64_t) pe->add_len);
+    
+    pos = SESSION_HEADER;
+    for(x = 0; x < pe->piece_count; x++) {
+      pp = &((pe->pPiece)[x]);
+      aksview_write8(ps, pos, pp->kind);
+      writeInt(ps, pos + 1, pSidecarType, (uint64_t) pp->src);
+      writeInt(ps, pos + 9, pSidecarType, (uint64_t) pp->len);
+      pos += SESSION_PIECE;
+    }
+    
+    for(x = 0; x < pe->add_len; x += blen) {
+      if (pe->add_len - x < BLOCK_SIZE) {
+        blen = (int32_t) (pe->add_len - x);
+      } else {
+        blen = BLOCK_SIZE;
+      }
+      writeBlock(ps, pos + x, pe->pAdd + x, blen);
+    }
+  }
+  
+  /* Close session file and release path */
+  aksview_close(ps);
+  free(pSPath);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Insert a new piece into the piece table of an edit session.
+ * 
+ * This only changes the piece table; the caller is responsible for
+ * updating the logical length.
+ * 
+ * Parameters:
+ * 
+ *   pe - the edit session
+ * 
+ *   i - the index to insert the piece at
+ * 
+ *   kind - the kind of piece
+ * 
+ *   src - the source offset of the piece
+ * 
+ *   len - the length of the piece
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if the piece table is full or the
+ *   memory budget is exceeded
+ */
+static int sessionAddPiece(
+    EDIT_SESSION *pe,
+    int32_t i,
+    int kind,
+    int64_t src,
+    int64_t len) {
+  
+  int status = 1;
+  int32_t new_cap = 0;
+  PIECE *pNew = NULL;
+  
+  /* Check parameters */
+  if ((pe == NULL) || (i < 0) || (i > pe->piece_count) || (len < 1)) {
+    fault(__LINE__);
+  }
+  
+  /* Grow the table if necessary */
+  if (pe->piece_count >= SESSION_MAXPIECES) {
+    status = 0;
+    
+  } else if (pe->piece_count >= pe->piece_cap) {
+    new_cap = pe->piece_cap * 2;
+    if (new_cap < 64) {
+      new_cap = 64;
+    }
+    if (new_cap > SESSION_MAXPIECES) {
+      new_cap = SESSION_MAXPIECES;
+    }
+    pNew = (PIECE *) bufGrow(pe->pPiece,
+                    ((int64_t) new_cap) * ((int64_t) sizeof(PIECE)));
+    if (pNew != NULL) {
+      pe->pPiece = pNew;
+      pe->piece_cap = new_cap;
+    } else {
+      status = 0;
+    }
+  }
+  
+  /* Shift the following pieces up and store the new piece */
+  if (status) {
+    memmove(&((pe->pPiece)[i + 1]), &((pe->pPiece)[i]),
+              ((size_t) (pe->piece_count - i)) * sizeof(PIECE));
+    (pe->pPiece)[i].kind = kind;
+    (pe->pPiece)[i].src = src;
+    (pe->pPiece)[i].len = len;
+    (pe->piece_count)++;
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Make sure that a piece boundary exists at a given logical offset in
+ * an edit session, splitting a piece if necessary.
+ * 
+ * Parameters:
+ * 
+ *   pe - the edit session
+ * 
+ *   pos - the logical offset, in range [0, logical length]
+ * 
+ * Return:
+ * 
+ *   the index of the piece that starts at the offset, or the piece
+ *   count if the offset is the logical length, or -1 if the piece table
+ *   is full or the memory budget is exceeded
+ */
+static int32_t sessionSplit(EDIT_SESSION *pe, int64_t pos) {
+  
+  int32_t i = 0;
+  int64_t off = 0;
+  int64_t skip = 0;
+  PIECE *pp = NULL;
+  
+  /* Check parameters */
+  if ((pe == NULL) || (pos < 0) || (pos > pe->len)) {
+    fault(__LINE__);
+  }
+  
+  /* Find the piece containing the offset */
+  for(i = 0; i < pe->piece_count; i++) {
+    pp = &((pe->pPiece)[i]);
+    if (pos == off) {
+      break;
+    }
+    if (pos < off + pp->len) {
+      /* Offset is within this piece, so split it */
+      skip = pos - off;
+      if (pp->kind == PIECE_ZERO) {
+        if (!sessionAddPiece(pe, i + 1, PIECE_ZERO, 0, pp->len - skip)) {
+          i = -1;
+        }
+      } else {
+        if (!sessionAddPiece(pe, i + 1, pp->kind, pp->src + skip,
+                              pp->len - skip)) {
+          i = -1;
+        }
+      }
+      
+      /* Shorten the first half; the table may have moved */
+      if (i >= 0) {
+        (pe->pPiece)[i].len = skip;
+        i++;
+      }
+      break;
+    }
+    off += pp->len;
+  }
+  
+  /* Return index */
+  return i;
+}
+
+/*
+ * Insert bytes at a logical offset in an edit session.
+ * 
+ * If pData is NULL, zero-valued bytes are inserted without using the
+ * add-buffer.  Otherwise, the bytes are appended to the add-buffer.
+ * 
+ * Parameters:
+ * 
+ *   pe - the edit session
+ * 
+ *   pos - the logical offset, in range [0, logical length]
+ * 
+ *   pData - the bytes to insert, or NULL for zero bytes
+ * 
+ *   len - the number of bytes to insert
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if the piece table is full or the
+ *   memory budget is exceeded
+ */
+static int sessionInsert(
+    EDIT_SESSION *pe,
+    int64_t pos,
+    const uint8_t *pData,
+    int64_t len) {
+  
+  int status = 1;
+  int32_t i = 0;
+  int64_t new_cap = 0;
+  uint8_t *pNew = NULL;
+  
+  /* Check parameters */
+  if ((pe == NULL) || (pos < 0) || (pos > pe->len) || (len < 0) ||
+      (len > AKSVIEW_MAXLEN - pe->len)) {
+    fault(__LINE__);
+  }
+  
+  /* Split at the insertion point, unless there is nothing to insert */
+  if (len > 0) {
+    i = sessionSplit(pe, pos);
+    if (i < 0) {
+      status = 0;
+    }
+  }
+  
+  /* Insert the new piece */
+  if (status && (len > 0) && (pData == NULL)) {
+    status = sessionAddPiece(pe, i, PIECE_ZERO, 0, len);
+    
+  } else if (status && (len > 0)) {
+    /* Grow the add-buffer if necessary, then append the data */
+    if (pe->add_len + len > pe->add_cap) {
+      new_cap = (pe->add_cap * 2) + len;
+      pNew = (uint8_t *) bufGrow(pe->pAdd, new_cap);
+      if (pNew != NULL) {
+        pe->pAdd = pNew;
+        pe->add_cap = new_cap;
+      } else {
+        status = 0;
+      }
+    }
+    if (status) {
+      memcpy(pe->pAdd + pe->add_len, pData, (size_t) len);
+      status = sessionAddPiece(pe, i, PIECE_ADD, pe->add_len, len);
+    }
+    if (status) {
+      pe->add_len += len;
+    }
+  }
+  
+  /* Update the logical length */
+  if (status) {
+    pe->len += len;
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Remove a range of bytes from an edit session.
+ * 
+ * Parameters:
+ * 
+ *   pe - the edit session
+ * 
+ *   pos - the logical offset of the first byte to remove
+ * 
+ *   len - the number of bytes to remove
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if the piece table is full or the
+ *   memory budget is exceeded
+ */
+static int sessionRemove(EDIT_SESSION *pe, int64_t pos, int64_t len) {
+  
+  int status = 1;
+  int32_t i = 0;
+  int32_t j = 0;
+  
+  /* Check parameters */
+  if ((pe == NULL) || (pos < 0) || (len < 0) || (pos > pe->len) ||
+      (len > pe->len - pos)) {
+    fault(__LINE__);
+  }
+  
+  /* Split at both ends of the range */
+  if (len > 0) {
+    i = sessionSplit(pe, pos);
+    if (i >= 0) {
+      j = sessionSplit(pe, pos + len);
+    }
+    if ((i < 0) || (j < 0)) {
+      status = 0;
+    }
+  }
+  
+  /* Drop the pieces within the range */
+  if (status && (len > 0)) {
+    memmove(&((pe->pPiece)[i]), &((pe->pPiece)[j]),
+              ((size_t) (pe->piece_count - j)) * sizeof(PIECE));
+    pe->piece_count -= (j - i);
+    pe->len -= len;
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Read a block of bytes from an edit session, as seen through its
+ * overlay.
+ * 
+ * The caller must ensure that the whole block is within the logical
+ * length of the session.
+ * 
+ * Parameters:
+ * 
+ *   pe - the edit session
+ * 
+ *   pos - the logical offset of the first byte of the block
+ * 
+ *   pBuf - the buffer to receive the bytes
+ * 
+ *   len - the number of bytes to read
+ */
+static void sessionRead(
+    const EDIT_SESSION *pe,
+    int64_t pos,
+    uint8_t *pBuf,
+    int32_t len) {
+  
+  int32_t i = 0;
+  int64_t off = 0;
+  int64_t lo = 0;
+  int64_t hi = 0;
+  const PIECE *pp = NULL;
+  
+  /* Check parameters */
+  if ((pe == NULL) || (pos < 0) || (pBuf == NULL) || (len < 0) ||
+      (pos > pe->len - len)) {
+    fault(__LINE__);
+  }
+  
+  /* Copy the overlapping part of each piece */
+  for(i = 0; (i < pe->piece_count) && (off < pos + len); i++) {
+    pp = &((pe->pPiece)[i]);
+    
+    lo = off;
+    hi = off + pp->len;
+    if (lo < pos) {
+      lo = pos;
+    }
+    if (hi > pos + len) {
+      hi = pos + len;
+    }
+    
+    if (lo < hi) {
+      if (pp->kind == PIECE_ORIG) {
+        readBlock(pe->pv, pp->src + (lo - off), pBuf + (lo - pos),
+                    (int32_t) (hi - lo));
+      } else if (pp->kind == PIECE_ADD) {
+        memcpy(pBuf + (lo - pos), pe->pAdd + pp->src + (lo - off),
+                (size_t) (hi - lo));
+      } else {
+        memset(pBuf + (lo - pos), 0, (size_t) (hi - lo));
+      }
+    }
+    
+    off += pp->len;
+  }
+}
+
+/*
+ * Write all the edits of an edit session into the original file.
+ * 
+ * The view of the original file in the session must be writable.  Only
+ * the extents that differ from the original file are written, in a
+ * single sorted pass over the piece table.  Original data that has
+ * shifted to higher offsets is moved first, from the end backwards, and
+ * original data that has shifted to lower offsets is moved next, from
+ * the start forwards, so no original byte is overwritten before it has
+ * been moved.  The added and zero pieces are written last.
+ * 
+ * Parameters:
+ * 
+ *   pe - the edit session
+ * 
+ *   pBuf - a buffer of BLOCK_SIZE bytes
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int sessionCommit(const EDIT_SESSION *pe, uint8_t *pBuf) {
+  
+  int status = 1;
+  int32_t i = 0;
+  int64_t off = 0;
+  int64_t done = 0;
+  int32_t blen = 0;
+  const PIECE *pp = NULL;
+  
+  /* Check parameters */
+  if ((pe == NULL) || (pBuf == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Extend the file first if it is growing */
+  if (pe->len > pe->orig_len) {
+    if (!aksview_setlen(pe->pv, pe->len)) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to set length on file!\n", pModule);
+    }
+  }
+  
+  /* Move original data that shifted up, from the end backwards */
+  if (status) {
+    off = pe->len;
+    for(i = pe->piece_count - 1; i >= 0; i--) {
+      pp = &((pe->pPiece)[i]);
+      off -= pp->len;
+      if ((pp->kind == PIECE_ORIG) && (pp->src < off)) {
+        moveRange(pe->pv, pp->src, off, pp->len, pBuf);
+      }
+    }
+  }
+  
+  /* Move original data that shifted down, from the start forwards */
+  if (status) {
+    off = 0;
+    for(i = 0; i < pe->piece_count; i++) {
+      pp = &((pe->pPiece)[i]);
+      if ((pp->kind == PIECE_ORIG) && (pp->src > off)) {
+        moveRange(pe->pv, pp->src, off, pp->len, pBuf);
+      }
+      off += pp->len;
+    }
+  }
+  
+  /* Write the added and zero pieces */
+  if (status) {
+    off = 0;
+    for(i = 0; i < pe->piece_count; i++) {
+      pp = &((pe->pPiece)[i]);
+      if (pp->kind == PIECE_ZERO) {
+        memset(pBuf, 0, BLOCK_SIZE);
+      }
+      if (pp->kind != PIECE_ORIG) {
+        for(done = 0; done < pp->len; done += blen) {
+          if (pp->len - done < BLOCK_SIZE) {
+            blen = (int32_t) (pp->len - done);
+          } else {
+            blen = BLOCK_SIZE;
+          }
+          if (pp->kind == PIECE_ADD) {
+            writeBlock(pe->pv, off + done,
+                        pe->pAdd + pp->src + done, blen);
+          } else {
+            writeBlock(pe->pv, off + done, pBuf, blen);
+          }
+        }
+      }
+      off += pp->len;
+    }
+  }
+  
+  /* Shorten the file last if it is shrinking */
+  if (status && (pe->len < pe->orig_len)) {
+    if (!aksview_setlen(pe->pv, pe->len)) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to set length on file!\n", pModule);
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+#ifdef BINPOKE_GZIP
+
+/*
+ * Memory allocation function given to zlib, which takes the memory of
+ * the inflater from the buffer pool.
+ * 
+ * Parameters:
+ * 
+ *   opaque - unused
+ * 
+ *   items - the number of items to allocate
+ * 
+ *   size - the size in bytes of each item
+ * 
+ * Return:
+ * 
+ *   the memory, or Z_NULL if the memory budget is exceeded
+ */
+static voidpf gzAlloc(voidpf opaque, uInt items, uInt size) {
+  
+  void *pResult = NULL;
+  
+  /* Ignore opaque parameter */
+  (void) opaque;
+  
+  /* Take the memory from the pool */
+  pResult = bufAlloc(((int64_t) items) * ((int64_t) size));
+  if (pResult == NULL) {
+    pResult = Z_NULL;
+  }
+  
+  /* Return result */
+  return (voidpf) pResult;
+}
+
+/*
+ * Memory release function given to zlib, which returns memory taken by
+ * gzAlloc() to the buffer pool.
+ * 
+ * Parameters:
+ * 
+ *   opaque - unused
+ * 
+ *   address - the memory to release
+ */
+static void gzFree(voidpf opaque, voidpf address) {
+  (void) opaque;
+  bufFree((void *) address);
+}
+
+/*
+ * Start an inflater whose memory comes from the buffer pool.
+ * 
+ * The stream structure is reset before the inflater is started.  If the
+ * memory budget is exceeded, the error is reported to stderr.  Any other
+ * failure to start is a fault.
+ * 
+ * Parameters:
+ * 
+ *   pstrm - the stream structure
+ * 
+ *   bits - the window bits given to inflateInit2()
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int gzStart(z_stream *pstrm, int bits) {
+  
+  int status = 1;
+  int ret = Z_OK;
+  
+  /* Check parameter */
+  if (pstrm == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Reset the stream and start the inflater */
+  memset(pstrm, 0, sizeof(z_stream));
+  pstrm->zalloc = gzAlloc;
+  pstrm->zfree = gzFree;
+  pstrm->opaque = Z_NULL;
+  
+  ret = inflateInit2(pstrm, bits);
+  if (ret == Z_MEM_ERROR) {
+    status = 0;
+  } else if (ret != Z_OK) {
+    fault(__LINE__);
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Add a seek point to a gzip index that is being built.
+ * 
+ * The window is the circular output buffer of GZIP_WINSIZE bytes used
+ * while building, with left bytes unused at its end.
+ * 
+ * Parameters:
+ * 
+ *   pi - the index sidecar
+ * 
+ *   k - the number of seek points already in the index
+ * 
+ *   out - the uncompressed offset of the seek point
+ * 
+ *   in - the compressed offset of the seek point
+ * 
+ *   bits - the number of bits of the byte before in that belong to the
+ *   seek point, in range [0, 7]
+ * 
+ *   pWin - the circular output buffer
+ * 
+ *   left - the number of unused bytes at the end of the output buffer
+ * 
+ *   pBuf - a buffer of at least GZIP_WINSIZE bytes
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int gzAddPoint(
+    AKSVIEW *pi,
+    int64_t k,
+    int64_t out,
+    int64_t in,
+    int bits,
+    const uint8_t *pWin,
+    int32_t left,
+    uint8_t *pBuf) {
+  
+  int status = 1;
+  int64_t pos = 0;
+  
+  /* Check parameters */
+  if ((pi == NULL) || (k < 0) || (out < 0) || (in < 0) ||
+      (bits < 0) || (bits > 7) || (pWin == NULL) || (left < 0) ||
+      (left > GZIP_WINSIZE) || (pBuf == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Unroll the circular output buffer so that the most recent byte is
+   * at the end of the window */
+  if (left > 0) {
+    memcpy(pBuf, pWin + GZIP_WINSIZE - left, (size_t) left);
+  }
+  if (left < GZIP_WINSIZE) {
+    memcpy(pBuf + left, pWin, (size_t) (GZIP_WINSIZE - left));
+  }
+  
+  /* Extend the index and write the seek point */
+  pos = GZIP_HEADER + (k * GZIP_POINT);
+  if (!aksview_setlen(pi, pos + GZIP_POINT)) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to set length on gzip index!\n",
+              pModule);
+  }
+  
+  if (status) {
+    writeInt(pi, pos, pSidecarType, (uint64_t) out);
+    writeInt(pi, pos + 8, pSidecarType, (uint64_t) in);
+    aksview_write8(pi, pos + 16, bits);
+    writeBlock(pi, pos + 17, pBuf, GZIP_WINSIZE);
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Build the seek-point index of a gzip file by decompressing the whole
+ * file once.
+ * 
+ * A seek point is recorded at the first deflate block boundary after
+ * every GZIP_SPAN bytes of uncompressed data.  The members of a
+ * multi-member file are decoded one after the other as a single
+ * uncompressed stream, so seek points may be in any member.  Anything
+ * after the trailer of a member that is not another member is reported
+ * as corrupt data.
+ * 
+ * Parameters:
+ * 
+ *   pz - the gzip reader, with the compressed file view open, the index
+ *   sidecar open, and the buffers allocated
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int gzBuildIndex(GZ_READER *pz) {
+  
+  int status = 1;
+  int ret = Z_OK;
+  int done = 0;
+  int j = 0;
+  int32_t n = 0;
+  
+  int64_t in_pos = 0;
+  int64_t totin = 0;
+  int64_t totout = 0;
+  int64_t last = 0;
+  int64_t count = 0;
+  
+  z_stream strm;
+  
+  /* Initialize structures */
+  memset(&strm, 0, sizeof(z_stream));
+  
+  /* Check parameter */
+  if (pz == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Empty any stale index and start a stream that decodes the gzip
+   * header automatically */
+  if (!aksview_setlen(pz->pi, GZIP_HEADER)) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to set length on gzip index!\n",
+              pModule);
+  }
+  
+  if (status) {
+    status = gzStart(&strm, 47);
+  }
+  
+  /* Decompress every member, adding seek points at block
+   * boundaries */
+  while (status && (!done)) {
+    /* Refill the input buffer */
+    if (strm.avail_in == 0) {
+      if (pz->comp_len - in_pos < BLOCK_SIZE) {
+        n = (int32_t) (pz->comp_len - in_pos);
+      } else {
+        n = BLOCK_SIZE;
+      }
+      if (n < 1) {
+        status = 0;
+        fprintf(stderr, "%s: Compressed data is truncated!\n", pModule);
+        break;
+      }
+      readBlock(pz->pv, in_pos, pz->pIn, n);
+      in_pos += n;
+      strm.next_in = pz->pIn;
+      strm.avail_in = (uInt) n;
+    }
+    
+    /* Decompress through the circular output buffer, stopping at each
+     * block boundary */
+    do {
+      if (strm.avail_out == 0) {
+        strm.next_out = pz->pWin;
+        strm.avail_out = GZIP_WINSIZE;
+      }
+      
+      totin += strm.avail_in;
+      totout += strm.avail_out;
+      ret = inflate(&strm, Z_BLOCK);
+      totin -= strm.avail_in;
+      totout -= strm.avail_out;
+      
+      if ((ret != Z_OK) && (ret != Z_STREAM_END) && (ret != Z_BUF_ERROR)) {
+        status = 0;
+        fprintf(stderr, "%s: Compressed data is corrupt!\n", pModule);
+        break;
+      }
+      
+      /* At the end of a member, including its trailer, finish if it is
+       * the end of the file, or else go on to the next member */
+      if (ret == Z_STREAM_END) {
+        if (in_pos - ((int64_t) strm.avail_in) >= pz->comp_len) {
+          done = 1;
+          break;
+        }
+        if (inflateReset(&strm) != Z_OK) {
+          fault(__LINE__);
+        }
+        continue;
+      }
+      
+      if ((strm.data_type & 128) && (!(strm.data_type & 64)) &&
+          ((totout == 0) || (totout - last > GZIP_SPAN))) {
+        status = gzAddPoint(pz->pi, count, totout, totin,
+                    strm.data_type & 7, pz->pWin,
+                    (int32_t) strm.avail_out, pz->pSkip);
+        count++;
+        last = totout;
+      }
+    } while (status && (strm.avail_in != 0));
+  }
+  
+  inflateEnd(&strm);
+  
+  /* Write the header last, so an interrupted build leaves an index
+   * that will be rebuilt */
+  if (status) {
+    writeInt(pz->pi, 8, pSidecarType, (uint64_t) pz->comp_len);
+    writeInt(pz->pi, 16, pSidecarType, (uint64_t) totout);
+    writeInt(pz->pi, 24, pSidecarType, (uint64_t) count);
+    writeInt(pz->pi, 32, pSidecarType, (uint64_t) GZIP_SPAN);
+    writeInt(pz->pi, 40, pSidecarType, (uint64_t) pz->stamp);
+    writeInt(pz->pi, 48, pSidecarType, pz->trailer);
+    for(j = 0; j < 8; j++) {
+      aksview_write8(pz->pi, j, (GZIP_SIGNATURE)[j]);
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Check whether the header of a gzip index is valid and matches the
+ * compressed file, loading the header fields into the reader if so.
+ * 
+ * The index matches if the length, the modification time, and the
+ * trailer of the compressed file are all the same as when the index
+ * was built.  A file that was replaced by another of the same length
+ * therefore gets a new index.  An index built within MANIFEST_SLACK
+ * seconds of the file being modified has no time recorded, so it is
+ * rebuilt once the time is known.
+ * 
+ * Parameters:
+ * 
+ *   pz - the gzip reader, with the compressed file view and the index
+ *   sidecar open
+ * 
+ * Return:
+ * 
+ *   non-zero if the index is valid, zero if it must be rebuilt
+ */
+static int gzCheckIndex(GZ_READER *pz) {
+  
+  int valid = 1;
+  int j = 0;
+  int64_t ilen = 0;
+  uint64_t uv = 0;
+  
+  /* Check parameter */
+  if (pz == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Check the signature */
+  ilen = aksview_getlen(pz->pi);
+  if (ilen < GZIP_HEADER) {
+    valid = 0;
+  }
+  for(j = 0; valid && (j < 8); j++) {
+    if (aksview_read8u(pz->pi, j) != (GZIP_SIGNATURE)[j]) {
+      valid = 0;
+    }
+  }
+  
+  /* Check that the index was built for this file with the current
+   * span, and that all seek points are present */
+  if (valid) {
+    if (readInt(pz->pi, 8, pSidecarType) != (uint64_t) pz->comp_len) {
+      valid = 0;
+    }
+    if (readInt(pz->pi, 32, pSidecarType) != (uint64_t) GZIP_SPAN) {
+      valid = 0;
+    }
+    if (readInt(pz->pi, 40, pSidecarType) != (uint64_t) pz->stamp) {
+      valid = 0;
+    }
+    if (readInt(pz->pi, 48, pSidecarType) != pz->trailer) {
+      valid = 0;
+    }
+  }
+  
+  if (valid) {
+    uv = readInt(pz->pi, 16, pSidecarType);
+    if (uv > (uint64_t) AKSVIEW_MAXLEN) {
+      valid = 0;
+    } else {
+      pz->len = (int64_t) uv;
+    }
+  }
+  
+  if (valid) {
+    uv = readInt(pz->pi, 24, pSidecarType);
+    if ((uv < 1) ||
+        (uv != (uint64_t) ((ilen - GZIP_HEADER) / GZIP_POINT)) ||
+        ((ilen - GZIP_HEADER) % GZIP_POINT != 0)) {
+      valid = 0;
+    } else {
+      pz->point_count = (int64_t) uv;
+    }
+  }
+  
+  /* Return result */
+  return valid;
+}
+
+/*
+ * Open a gzip file for random access through its seek-point index.
+ * 
+ * The index sidecar is created or rebuilt if it does not exist, is
+ * incomplete, or does not match the compressed file.  Errors are
+ * reported to stderr.
+ * 
+ * The reader structure must be empty when this function is called.  On
+ * return, it must be released with gzClose() whether or not opening
+ * succeeded.
+ * 
+ * Parameters:
+ * 
+ *   pz - the gzip reader to open
+ * 
+ *   pPath - the path to the gzip file
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int gzOpen(GZ_READER *pz, const char *pPath) {
+  
+  int status = 1;
+  int errcode = 0;
+  char *pIPath = NULL;
+  
+  /* Check parameters */
+  if ((pz == NULL) || (pPath == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Take buffers from the pool */
+  pz->pIn = (uint8_t *) bufAlloc(BLOCK_SIZE);
+  if (pz->pIn != NULL) {
+    pz->pSkip = (uint8_t *) bufAlloc(BLOCK_SIZE);
+  }
+  if (pz->pSkip != NULL) {
+    pz->pWin = (uint8_t *) bufAlloc(GZIP_WINSIZE);
+  }
+  if (pz->pWin != NULL) {
+    memset(pz->pWin, 0, GZIP_WINSIZE);
+  } else {
+    status = 0;
+  }
+  
+  /* Open the compressed file */
+  if (status) {
+    pz->pv = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
+    if (pz->pv == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, aksview_errstr(errcode));
+    } else {
+      pz->comp_len = aksview_getlen(pz->pv);
+      pz->stamp = fileStamp(pPath);
+      if (pz->comp_len >= 8) {
+        pz->trailer = readInt(pz->pv, pz->comp_len - 8, pSidecarType);
+      }
+    }
+  }
+  
+  /* Open the index sidecar, creating it if necessary */
+  if (status) {
+    pIPath = sidecarPath(pPath, GZIP_SUFFIX);
+    pz->pi = aksview_create(pIPath, AKSVIEW_REGULAR, &errcode);
+    if (pz->pi == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open gzip index: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
+  }
+  
+  /* Build the index if it is not usable */
+  if (status && (!gzCheckIndex(pz))) {
+    status = gzBuildIndex(pz);
+    if (status && (!gzCheckIndex(pz))) {
+      fault(__LINE__);
+    }
+  }
+  
+  /* Release path */
+  free(pIPath);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Release all resources held by a gzip reader.
+ * 
+ * The structure is reset to empty.  Does nothing to a reader that is
+ * already empty.
+ * 
+ * Parameters:
+ * 
+ *   pz - the gzip reader
+ */
+static void gzClose(GZ_READER *pz) {
+  
+  /* Check parameter */
+  if (pz == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Release resources and reset structure */
+  if (pz->active) {
+    inflateEnd(&(pz->strm));
+  }
+  aksview_close(pz->pv);
+  aksview_close(pz->pi);
+  bufFree(pz->pIn);
+  bufFree(pz->pSkip);
+  bufFree(pz->pWin);
+  memset(pz, 0, sizeof(GZ_READER));
+}
+
+/*
+ * Decompress the next bytes from the current position of an active
+ * gzip reader.
+ * 
+ * When the deflate data of a member ends, decompression carries on
+ * into the next member.
+ * 
+ * Parameters:
+ * 
+ *   pz - the gzip reader
+ * 
+ *   pOut - the buffer to receive the bytes
+ * 
+ *   n - the number of bytes to decompress
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int gzInflate(GZ_READER *pz, uint8_t *pOut, int32_t n) {
+  
+  int status = 1;
+  int ret = 0;
+  int32_t r = 0;
+  
+  /* Check parameters */
+  if ((pz == NULL) || (pOut == NULL) || (n < 0) || (!(pz->active))) {
+    fault(__LINE__);
+  }
+  
+  /* Decompress until all bytes are produced */
+  while (status && (n > 0)) {
+    /* Refill the input buffer */
+    if (pz->strm.avail_in == 0) {
+      if (pz->comp_len - pz->in_pos < BLOCK_SIZE) {
+        r = (int32_t) (pz->comp_len - pz->in_pos);
+      } else {
+        r = BLOCK_SIZE;
+      }
+      if (r < 1) {
+        status = 0;
+        fprintf(stderr, "%s: Compressed data is truncated!\n", pModule);
+        break;
+      }
+      readBlock(pz->pv, pz->in_pos, pz->pIn, r);
+      pz->in_pos += r;
+      pz->strm.next_in = pz->pIn;
+      pz->strm.avail_in = (uInt) r;
+    }
+    
+    /* Decompress as much as possible */
+    pz->strm.next_out = pOut;
+    pz->strm.avail_out = (uInt) n;
+    ret = inflate(&(pz->strm), Z_NO_FLUSH);
+    
+    r = n - ((int32_t) pz->strm.avail_out);
+    pOut += r;
+    n -= r;
+    pz->out_pos += r;
+    
+    if ((ret == Z_STREAM_END) && (n > 0)) {
+      /* The member has ended, so skip its trailer unless the inflater
+       * has already decoded it, and go on to the next member */
+      if (!(pz->wrapped)) {
+        pz->in_pos += 8 - ((int64_t) pz->strm.avail_in);
+        pz->strm.avail_in = 0;
+      }
+      if (pz->in_pos - ((int64_t) pz->strm.avail_in) >= pz->comp_len) {
+        status = 0;
+        fprintf(stderr, "%s: Compressed data is truncated!\n", pModule);
+      } else {
+        if (inflateReset2(&(pz->strm), 31) != Z_OK) {
+          fault(__LINE__);
+        }
+        pz->wrapped = 1;
+      }
+      
+    } else if ((ret != Z_OK) && (ret != Z_STREAM_END) &&
+                (ret != Z_BUF_ERROR)) {
+      status = 0;
+      fprintf(stderr, "%s: Compressed data is corrupt!\n", pModule);
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Read a block of uncompressed bytes through a gzip reader.
+ * 
+ * If the reader is already positioned at or shortly before the block,
+ * decompression simply continues, so sequential reads never decompress
+ * anything twice.  Otherwise, decompression restarts from the nearest
+ * seek point at or before the block.
+ * 
+ * The caller must ensure that the whole block is within the
+ * uncompressed length.
+ * 
+ * Parameters:
+ * 
+ *   pz - the gzip reader
+ * 
+ *   pos - the uncompressed offset of the first byte of the block
+ * 
+ *   pBuf - the buffer to receive the bytes
+ * 
+ *   len - the number of bytes to read
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int gzRead(GZ_READER *pz, int64_t pos, uint8_t *pBuf, int32_t len) {
+  
+  int status = 1;
+  int bits = 0;
+  int b = 0;
+  int64_t lo = 0;
+  int64_t hi = 0;
+  int64_t mid = 0;
+  int64_t ppos = 0;
+  int64_t out = 0;
+  int32_t n = 0;
+  
+  /* Check parameters */
+  if ((pz == NULL) || (pos < 0) || (pBuf == NULL) || (len < 0) ||
+      (pos > pz->len - len)) {
+    fault(__LINE__);
+  }
+  
+  /* Binary search for the last seek point at or before the block */
+  lo = 0;
+  hi = pz->point_count - 1;
+  while (lo < hi) {
+    mid = lo + ((hi - lo + 1) / 2);
+    out = (int64_t) readInt(pz->pi, GZIP_HEADER + (mid * GZIP_POINT),
+                              pSidecarType);
+    if (out <= pos) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  ppos = GZIP_HEADER + (lo * GZIP_POINT);
+  out = (int64_t) readInt(pz->pi, ppos, pSidecarType);
+  
+  /* Restart from the seek point unless the current position is already
+   * between the seek point and the block */
+  if ((!(pz->active)) || (pz->out_pos > pos) || (pz->out_pos < out)) {
+    if (pz->active) {
+      inflateEnd(&(pz->strm));
+      pz->active = 0;
+    }
+    status = gzStart(&(pz->strm), -15);
+    
+    if (status) {
+      pz->active = 1;
+      pz->wrapped = 0;
+      pz->out_pos = out;
+      pz->in_pos = (int64_t) readInt(pz->pi, ppos + 8, pSidecarType);
+      bits = (int) aksview_read8u(pz->pi, ppos + 16);
+      
+      if ((pz->in_pos < 1) || (pz->in_pos > pz->comp_len) ||
+          (bits < 0) || (bits > 7)) {
+        status = 0;
+        fprintf(stderr, "%s: Gzip index is corrupt!\n", pModule);
+      }
+    }
+    
+    if (status && (bits > 0)) {
+      b = (int) aksview_read8u(pz->pv, pz->in_pos - 1);
+      inflatePrime(&(pz->strm), bits, b >> (8 - bits));
+    }
+    
+    if (status) {
+      readBlock(pz->pi, ppos + 17, pz->pWin, GZIP_WINSIZE);
+      inflateSetDictionary(&(pz->strm), pz->pWin, GZIP_WINSIZE);
+    }
+  }
+  
+  /* Skip forward to the block */
+  while (status && (pz->out_pos < pos)) {
+    if (pos - pz->out_pos < BLOCK_SIZE) {
+      n = (int32_t) (pos - pz->out_pos);
+    } else {
+      n = BLOCK_SIZE;
+    }
+    status = gzInflate(pz, pz->pSkip, n);
+  }
+  
+  /* Decompress the block */
+  if (status) {
+    status = gzInflate(pz, pBuf, len);
+  }
+  
+  /* Return status */
+  return status;
+}
+
+#endif
+
+/*
+ * Read a block of bytes from a byte source.
+ * 
+ * The caller must ensure that the whole block is within the length of
+ * the source.
+ * 
+ * Parameters:
+ * 
+ *   ps - the byte source
+ * 
+ *   pos - the offset of the first byte of the block
+ * 
+ *   pBuf - the buffer to receive the bytes
+ * 
+ *   len - the number of bytes to read
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int sourceRead(
+    BYTE_SOURCE *ps,
+    int64_t pos,
+    uint8_t *pBuf,
+    int32_t len) {
+  
+  int status = 1;
+  int errcode = 0;
+  
+  /* Check parameter */
+  if (ps == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Read from whichever source is selected */
+  if (ps->pe != NULL) {
+    sessionRead(ps->pe, pos, pBuf, len);
+    
+  } else if (ps->pz != NULL) {
+#ifdef BINPOKE_GZIP
+    status = gzRead(ps->pz, pos, pBuf, len);
+#else
+    fault(__LINE__);
+#endif
+    
+  } else if (ps->pb != NULL) {
+    if (!binpoke_readbytes(ps->pb, pos, pBuf, len, &errcode)) {
+      status = 0;
+      fprintf(stderr, "%s: %s!\n", pModule, binpoke_errstr(errcode));
+    }
+    
+  } else {
+    fault(__LINE__);
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Read the next character of a path list or batch script.
+ * 
+ * If pb is NULL, the character is read from standard input and pPos is
+ * ignored.  Otherwise, the character is read from the handle at *pPos,
+ * which is then advanced.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle to read from, or NULL for standard input
+ * 
+ *   pPos - the read position within the file
+ * 
+ * Return:
+ * 
+ *   the unsigned byte value of the character, or -1 if no more
+ *   characters
+ */
+static int readListChar(BINPOKE *pb, int64_t *pPos) {
+  
+  int c = -1;
+  uint8_t b = 0;
+  
+  /* Check parameter */
+  if (pPos == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Read from the appropriate source */
+  if (pb == NULL) {
+    c = getchar();
+    if (c == EOF) {
+      c = -1;
+    }
+    
+  } else if (binpoke_readbytes(pb, *pPos, &b, 1, NULL)) {
+    c = (int) b;
+    (*pPos)++;
+  }
+  
+  /* Return result */
+  return c;
+}
+
+/*
+ * Print one line of a query of many files.
+ * 
+ * The line is the path, a tab, and the length in decimal.  If the
+ * length could not be found, the line is instead the path, a tab, the
+ * word "error", a tab, and the reason.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   flen - the length of the file, which is ignored if errcode is not
+ *   BINPOKE_ERR_NONE
+ * 
+ *   errcode - the libbinpoke error code of the query
+ */
+static void printQuery(const char *pPath, int64_t flen, int errcode) {
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Print the line */
+  if (errcode != BINPOKE_ERR_NONE) {
+    printf("%s\terror\t%s\n", pPath, binpoke_errstr(errcode));
+  } else {
+    printf("%s\t", pPath);
+    printInt64(flen);
+    printf("\n");
+  }
+}
+
+/*
+ * Print the length of a file as one line of a query of many files.
+ * 
+ * The length is found with binpoke_querylen() and the line is printed
+ * with printQuery().
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ * Return:
+ * 
+ *   non-zero if the length was printed, zero if error
+ */
+static int queryFile(const char *pPath) {
+  
+  int status = 1;
+  int errcode = BINPOKE_ERR_NONE;
+  int64_t flen = 0;
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Query and print the length */
+  status = binpoke_querylen(pPath, &flen, &errcode);
+  printQuery(pPath, flen, errcode);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Query the length of every file named in a path list.
+ * 
+ * The path list is a text file with one path per line.  Blank lines are
+ * skipped.  If pList is "-" then the path list is read from standard
+ * input.
+ * 
+ * Each file is queried in turn with queryFile() within this process, so
+ * one tab-separated line is printed for each.  Files that can not be
+ * queried are reported in their line and do not stop the run.
+ * 
+ * Parameters:
+ * 
+ *   pList - the path to the path list, or "-" for standard input
+ * 
+ * Return:
+ * 
+ *   non-zero if every file was queried, zero if any error
+ */
+static int queryList(const char *pList) {
+  
+  int status = 1;
+  int errcode = 0;
+  int c = 0;
+  
+  BINPOKE *pl = NULL;
+  int64_t lpos = 0;
+  
+  char *pLine = NULL;
+  char *pNew = NULL;
+  size_t llen = 0;
+  size_t lcap = 0;
+  
+  /* Check parameter */
+  if (pList == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Open the path list unless it is standard input */
+  if (strcmp(pList, "-") != 0) {
+    pl = binpoke_open(pList, BINPOKE_READONLY, &errcode);
+    if (pl == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open path list: %s\n",
+                pModule, binpoke_errstr(errcode));
+    }
+  }
+  
+  /* Take the initial line buffer from the buffer pool */
+  if (status) {
+    lcap = 256;
+    pLine = (char *) bufAlloc((int64_t) lcap);
+    if (pLine == NULL) {
+      status = 0;
+    }
+  }
+  
+  /* Process each line, unless the list failed to open or there is no
+   * line buffer */
+  if (!status) {
+    c = -1;
+  }
+  while (c >= 0) {
+    /* Read the line, not including the line break, growing the line
+     * buffer within the memory budget as necessary */
+    llen = 0;
+    for(c = readListChar(pl, &lpos);
+        (c >= 0) && (c != '\n');
+        c = readListChar(pl, &lpos)) {
+      if (llen + 1 >= lcap) {
+        pNew = (char *) bufGrow(pLine, (int64_t) (lcap * 2));
+        if (pNew == NULL) {
+          status = 0;
+          c = -1;
+          break;
+        }
+        pLine = pNew;
+        lcap *= 2;
+      }
+      pLine[llen] = (char) c;
+      llen++;
+    }
+    if (!status) {
+      break;
+    }
+    
+    /* Drop any carriage return and terminate the line */
+    if ((llen > 0) && (pLine[llen - 1] == '\r')) {
+      llen--;
+    }
+    pLine[llen] = 0;
+    
+    /* Skip blank lines */
+    if (llen < 1) {
+      continue;
+    }
+    
+    /* Query the file */
+    if (!queryFile(pLine)) {
+      status = 0;
+    }
+  }
+  
+  /* Release line buffer and close list if open */
+  bufFree(pLine);
+  binpoke_close(pl);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Read the next token from a text file through a handle.
+ * 
+ * Tokens are separated by whitespace.  A # character begins a comment
+ * that runs to the end of the line.
+ * 
+ * *pPos is the file offset to read from, and is advanced past the
+ * token.  The token is stored as a nul-terminated string in pBuf, which
+ * has room for bufsize characters including the terminating nul.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle to read from
+ * 
+ *   pPos - the read position
+ * 
+ *   pBuf - buffer to receive the token
+ * 
+ *   bufsize - the size of the buffer
+ * 
+ * Return:
+ * 
+ *   one if a token was read, zero if no more tokens, or -1 if a token
+ *   was too long for the buffer
+ */
+static int readToken(
+    BINPOKE *pb,
+    int64_t *pPos,
+    char *pBuf,
+    int bufsize) {
+  
+  int result = 0;
+  int c = 0;
+  int tlen = 0;
+  
+  /* Check parameters */
+  if ((pb == NULL) || (pPos == NULL) || (pBuf == NULL) ||
+      (bufsize < 2)) {
+    fault(__LINE__);
+  }
+  
+  /* Skip whitespace and comments */
+  for(c = readListChar(pb, pPos); c >= 0; c = readListChar(pb, pPos)) {
+    if (c == '#') {
+      for( ; (c >= 0) && (c != '\n'); c = readListChar(pb, pPos));
+      
+    } else if ((c != ' ') && (c != '\t') && (c != '\r') &&
+                (c != '\n')) {
+      break;
+    }
+  }
+  
+  /* Read the token characters, leaving the position just after the
+   * token */
+  for( ; c >= 0; c = readListChar(pb, pPos)) {
+    if ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') ||
+        (c == '#')) {
+      (*pPos)--;
+      break;
+    }
+    
+    if (tlen >= bufsize - 1) {
+      result = -1;
+      break;
+    }
+    
+    pBuf[tlen] = (char) c;
+    tlen++;
+    result = 1;
+  }
+  
+  /* Terminate the token */
+  pBuf[tlen] = 0;
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Get the value of a base-16 digit.
+ * 
+ * Parameters:
+ * 
+ *   c - the character
+ * 
+ * Return:
+ * 
+ *   the digit value in range [0, 15], or -1 if the character is not a
+ *   base-16 digit
+ */
+static int hexDigit(int c) {
+  
+  int d = -1;
+  
+  if ((c >= '0') && (c <= '9')) {
+    d = c - '0';
+  } else if ((c >= 'a') && (c <= 'f')) {
+    d = c - 'a' + 10;
+  } else if ((c >= 'A') && (c <= 'F')) {
+    d = c - 'A' + 10;
+  }
+  
+  return d;
+}
+
+/*
+ * Read the next line from a line reader.
+ * 
+ * The line is stored nul-terminated in the line buffer of the reader,
+ * without its line break, and with any trailing whitespace removed.
+ * The line number of the reader is advanced.
+ * 
+ * Parameters:
+ * 
+ *   pr - the line reader
+ * 
+ * Return:
+ * 
+ *   one if a line was read, zero if there are no more lines, or -1 if
+ *   the line is longer than LINE_MAXLEN
+ */
+static int lineRead(LINE_READER *pr) {
+  
+  int result = 0;
+  int c = 0;
+  int32_t n = 0;
+  
+  /* Check parameter */
+  if (pr == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Read characters up to the line break or end of file */
+  pr->line_len = 0;
+  while (result >= 0) {
+    /* Refill the block buffer if it is empty */
+    if ((pr->blk_pos >= pr->blk_len) && (pr->pos < pr->len)) {
+      if (pr->len - pr->pos < BLOCK_SIZE) {
+        n = (int32_t) (pr->len - pr->pos);
+      } else {
+        n = BLOCK_SIZE;
+      }
+      readBlock(pr->pv, pr->pos, pr->pBlk, n);
+      pr->pos += n;
+      pr->blk_pos = 0;
+      pr->blk_len = n;
+    }
+    
+    /* Leave loop at end of file */
+    if (pr->blk_pos >= pr->blk_len) {
+      break;
+    }
+    
+    /* Get the next character, leaving loop at the line break */
+    c = (int) (pr->pBlk)[pr->blk_pos];
+    (pr->blk_pos)++;
+    result = 1;
+    if (c == '\n') {
+      break;
+    }
+    
+    /* Append the character to the line */
+    if (pr->line_len >= LINE_MAXLEN) {
+      result = -1;
+    } else {
+      (pr->pLine)[pr->line_len] = (char) c;
+      (pr->line_len)++;
+    }
+  }
+  
+  /* Drop trailing whitespace, including any carriage return, and
+   * terminate the line */
+  while ((pr->line_len > 0) &&
+      (((pr->pLine)[pr->line_len - 1] == ' ') ||
+        ((pr->pLine)[pr->line_len - 1] == '\t') ||
+        ((pr->pLine)[pr->line_len - 1] == '\r'))) {
+    (pr->line_len)--;
+  }
+  (pr->pLine)[pr->line_len] = 0;
+  
+  /* Advance the line number */
+  if (result != 0) {
+    (pr->line_num)++;
+  }
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Write out the pending run of bytes of an import.
+ * 
+ * Does nothing if the run is empty or the import is only being checked.
+ * 
+ * Parameters:
+ * 
+ *   pis - the import state
+ */
+static void importFlush(IMPORT_STATE *pis) {
+  
+  /* Check parameter */
+  if (pis == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Write the run and empty it */
+  if ((pis->pv != NULL) && (pis->run_len > 0)) {
+    writeBlock(pis->pv, pis->run_addr, pis->pRun, pis->run_len);
+    if (pis->pCache != NULL) {
+      cacheDrop(pis->pCache, pis->run_addr, pis->run_len);
+    }
+  }
+  pis->run_len = 0;
+}
+
+/*
+ * Import a single byte.
+ * 
+ * Consecutive bytes are coalesced into runs of up to BLOCK_SIZE bytes,
+ * which are written out with a single block write.
+ * 
+ * Parameters:
+ * 
+ *   pis - the import state
+ * 
+ *   addr - the file offset of the byte
+ * 
+ *   v - the byte value
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if the byte is outside the file limits
+ */
+static int importByte(IMPORT_STATE *pis, int64_t addr, int v) {
+  
+  int status = 1;
+  
+  /* Check parameters */
+  if ((pis == NULL) || (addr < 0) || (v < 0) || (v > 255)) {
+    fault(__LINE__);
+  }
+  
+  /* Check the file limits */
+  if (addr >= pis->flen) {
+    status = 0;
+  }
+  
+  /* Start a new run if the byte does not extend the current one */
+  if (status && (pis->pv != NULL)) {
+    if ((pis->run_len >= BLOCK_SIZE) ||
+        ((pis->run_len > 0) &&
+          (addr != pis->run_addr + pis->run_len))) {
+      importFlush(pis);
+    }
+    if (pis->run_len < 1) {
+      pis->run_addr = addr;
+    }
+    (pis->pRun)[pis->run_len] = (uint8_t) v;
+    (pis->run_len)++;
+  }
+  
+  /* Update the next address and the span of imported addresses */
+  if (status) {
+    pis->next = addr + 1;
+    if ((pis->hi < 1) || (addr < pis->lo)) {
+      pis->lo = addr;
+    }
+    if (addr + 1 > pis->hi) {
+      pis->hi = addr + 1;
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Import a sequence of base-16 byte values.
+ * 
+ * The string is a sequence of tokens separated by whitespace, where
+ * each token is an even number of base-16 digits.  Each pair of digits
+ * is one byte, and the bytes are imported at consecutive addresses.
+ * 
+ * Parameters:
+ * 
+ *   pis - the import state
+ * 
+ *   pstr - the string to import
+ * 
+ *   addr - the file offset of the first byte
+ * 
+ *   line - the line number, for error messages
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int importHex(
+    IMPORT_STATE *pis,
+    const char *pstr,
+    int64_t addr,
+    int64_t line) {
+  
+  int status = 1;
+  int hi = 0;
+  int lo = 0;
+  
+  /* Check parameters */
+  if ((pis == NULL) || (pstr == NULL) || (addr < 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Decode each pair of digits, skipping whitespace between tokens */
+  while (status && (*pstr != 0)) {
+    if ((*pstr == ' ') || (*pstr == '\t')) {
+      pstr++;
+      continue;
+    }
+    
+    hi = hexDigit(*pstr);
+    lo = -1;
+    if (hi >= 0) {
+      lo = hexDigit(pstr[1]);
+    }
+    if (lo < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Invalid hex data on listing line ", pModule);
+      fprintInt64(stderr, line);
+      fprintf(stderr, "!\n");
+    }
+    
+    if (status) {
+      if (!importByte(pis, addr, (hi << 4) | lo)) {
+        status = 0;
+        fprintf(stderr, "%s: Listing line ", pModule);
+        fprintInt64(stderr, line);
+        fprintf(stderr, " is outside file limits!\n");
+      }
+    }
+    
+    if (status) {
+      pstr += 2;
+      addr++;
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Import one line of a listing.
+ * 
+ * The line must already have its line break and trailing whitespace
+ * removed.  Blank lines are ignored.
+ * 
+ * A line consisting of a "*" is a collapse marker, which repeats the
+ * bytes of the previous listing line in every paragraph up to the
+ * address of the next listing line.
+ * 
+ * A line that begins with base-16 digits followed by a colon is a
+ * listing line.  If its byte field has the exact layout that
+ * printListLine() produces, each byte is placed by its column, so that
+ * missing bytes are skipped.  Otherwise, the byte field is decoded as
+ * plain hex data at the address of the line.  Anything after a "|" is
+ * ignored.
+ * 
+ * Any other line is plain hex data, which is imported at the address
+ * following the last byte imported so far.
+ * 
+ * Parameters:
+ * 
+ *   pis - the import state
+ * 
+ *   pLine - the line, which may be modified
+ * 
+ *   line - the line number, for error messages
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int importLine(IMPORT_STATE *pis, char *pLine, int64_t line) {
+  
+  int status = 1;
+  int i = 0;
+  int j = 0;
+  int c1 = 0;
+  int c2 = 0;
+  int digits = 0;
+  int exact = 1;
+  int hex_count = 0;
+  int bv[16];
+  
+  int64_t addr = 0;
+  int64_t p = 0;
+  int32_t field_len = 0;
+  uint64_t uv = 0;
+  char *pField = NULL;
+  char *pBar = NULL;
+  
+  /* Check parameters */
+  if ((pis == NULL) || (pLine == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Skip leading whitespace */
+  while ((*pLine == ' ') || (*pLine == '\t')) {
+    pLine++;
+  }
+  
+  /* Count any leading base-16 digits */
+  while (hexDigit(pLine[digits]) >= 0) {
+    digits++;
+  }
+  
+  /* Handle each kind of line */
+  if (*pLine == 0) {
+    /* Blank line, so nothing to do */
+    
+  } else if (strcmp(pLine, "*") == 0) {
+    /* Collapse marker, which must follow a listing line with an exact
+     * layout */
+    if ((pis->pat_addr < 0) || pis->star) {
+      status = 0;
+      fprintf(stderr, "%s: Collapse marker on listing line ", pModule);
+      fprintInt64(stderr, line);
+      fprintf(stderr, " does not follow a listing line!\n");
+    } else {
+      pis->star = 1;
+    }
+    
+  } else if ((digits > 0) && (pLine[digits] == ':')) {
+    /* Listing line, so parse the address */
+    pLine[digits] = 0;
+    if ((digits > 16) || (!binpoke_parsehex(pLine, &uv)) ||
+        (uv > (uint64_t) INT64_MAX)) {
+      status = 0;
+      fprintf(stderr, "%s: Invalid address on listing line ", pModule);
+      fprintInt64(stderr, line);
+      fprintf(stderr, "!\n");
+    } else {
+      addr = (int64_t) uv;
+    }
+    
+    /* Listings only give the low 32 bits of addresses, so an
+     * eight-digit address that goes backwards crosses a 4G boundary */
+    if (status && (digits == 8) && (pis->last_addr >= 0)) {
+      if (pis->high > INT64_MAX - addr) {
+        status = 0;
+        fprintf(stderr, "%s: Invalid address on listing line ", pModule);
+        fprintInt64(stderr, line);
+        fprintf(stderr, "!\n");
+      } else {
+        addr += pis->high;
+      }
+      if (status && (addr < pis->last_addr)) {
+        if (addr > INT64_MAX - INT64_C(0x100000000)) {
+          status = 0;
+          fprintf(stderr, "%s: Invalid address on listing line ", pModule);
+          fprintInt64(stderr, line);
+          fprintf(stderr, "!\n");
+        } else {
+          addr += INT64_C(0x100000000);
+          pis->high += INT64_C(0x100000000);
+        }
+      }
+    }
+    
+    /* Fill any collapsed paragraphs before this line */
+    if (status && pis->star) {
+      if (addr <= pis->pat_addr) {
+        status = 0;
+        fprintf(stderr, "%s: Listing line ", pModule);
+        fprintInt64(stderr, line);
+        fprintf(stderr, " does not follow its collapse marker!\n");
+      }
+      for(p = pis->pat_addr + 16; status && (p < addr); p += 16) {
+        for(i = 0; i < 16; i++) {
+          if ((pis->pat_bv)[i] >= 0) {
+            if (!importByte(pis, p + i, (pis->pat_bv)[i])) {
+              status = 0;
+              fprintf(stderr, "%s: Collapse marker before listing line ",
+                        pModule);
+              fprintInt64(stderr, line);
+              fprintf(stderr, " is outside file limits!\n");
+              break;
+            }
+          }
+        }
+      }
+      pis->star = 0;
+    }
+    
+    /* Get the byte field, dropping any character column */
+    if (status) {
+      pis->last_addr = addr;
+      pField = pLine + digits + 1;
+      pBar = strchr(pField, '|');
+      if (pBar != NULL) {
+        *pBar = 0;
+      }
+      field_len = (int32_t) strlen(pField);
+    }
+    
+    /* Check whether the field has the exact layout, where byte i is in
+     * the two columns that start at 1 + 3i, plus two for the wider gap
+     * after the eighth byte */
+    if (status) {
+      for(j = 0; j < field_len; j++) {
+        if (pField[j] != ' ') {
+          if (hexDigit(pField[j]) >= 0) {
+            hex_count++;
+          } else {
+            exact = 0;
+          }
+        }
+      }
+      
+      for(i = 0; exact && (i < 16); i++) {
+        j = 1 + (3 * i);
+        if (i >= 8) {
+          j += 2;
+        }
+        
+        c1 = ' ';
+        c2 = ' ';
+        if (j < field_len) {
+          c1 = pField[j];
+        }
+        if (j + 1 < field_len) {
+          c2 = pField[j + 1];
+        }
+        
+        if ((c1 == ' ') && (c2 == ' ')) {
+          bv[i] = -1;
+          
+        } else if ((hexDigit(c1) >= 0) && (hexDigit(c2) >= 0)) {
+          bv[i] = (hexDigit(c1) << 4) | hexDigit(c2);
+          hex_count -= 2;
+          
+        } else {
+          exact = 0;
+        }
+      }
+      
+      if (hex_count != 0) {
+        exact = 0;
+      }
+    }
+    
+    /* Import the bytes by column if the layout is exact, else as plain
+     * hex data */
+    if (status && exact) {
+      for(i = 0; i < 16; i++) {
+        if (bv[i] >= 0) {
+          if (!importByte(pis, addr + i, bv[i])) {
+            status = 0;
+            fprintf(stderr, "%s: Listing line ", pModule);
+            fprintInt64(stderr, line);
+            fprintf(stderr, " is outside file limits!\n");
+            break;
+          }
+        }
+      }
+      if (status) {
+        memcpy(pis->pat_bv, bv, sizeof(bv));
+        pis->pat_addr = addr;
+      }
+      
+    } else if (status) {
+      status = importHex(pis, pField, addr, line);
+      pis->pat_addr = -1;
+    }
+    
+  } else {
+    /* Plain hex data, which can not follow a collapse marker */
+    if (pis->star) {
+      status = 0;
+      fprintf(stderr, "%s: Collapse marker before listing line ", pModule);
+      fprintInt64(stderr, line);
+      fprintf(stderr, " is not followed by a listing line!\n");
+    }
+    if (status) {
+      status = importHex(pis, pLine, pis->next, line);
+      pis->pat_addr = -1;
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Make one pass through a listing for the import verb.
+ * 
+ * If pv is NULL, the listing is only parsed and checked against the
+ * file length.  Otherwise, the bytes are also written into the file.
+ * Errors are reported to stderr.
+ * 
+ * Parameters:
+ * 
+ *   pl - view of the listing
+ * 
+ *   pv - view of the file to write into, or NULL to only check
+ * 
+ *   pCache - the cache dropper of the file, or NULL
+ * 
+ *   flen - the length of the file
+ * 
+ *   start - the address where plain hex data starts
+ * 
+ *   pBlk - a buffer of BLOCK_SIZE bytes for reading the listing
+ * 
+ *   pRun - a buffer of BLOCK_SIZE bytes for coalescing writes
+ * 
+ *   pLine - a buffer of LINE_MAXLEN + 1 characters for listing lines
+ * 
+ *   pSpan - an array of two integers that receives the lowest address
+ *   imported and the address following the highest address imported,
+ *   or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int importPass(
+    AKSVIEW *pl,
+    AKSVIEW *pv,
+    CACHE_DROP *pCache,
+    int64_t flen,
+    int64_t start,
+    uint8_t *pBlk,
+    uint8_t *pRun,
+    char *pLine,
+    int64_t *pSpan) {
+  
+  int status = 1;
+  int r = 0;
+  
+  LINE_READER lr;
+  IMPORT_STATE is;
+  
+  /* Initialize structures */
+  memset(&lr, 0, sizeof(LINE_READER));
+  memset(&is, 0, sizeof(IMPORT_STATE));
+  
+  /* Check parameters */
+  if ((pl == NULL) || (flen < 0) || (start < 0) || (pBlk == NULL) ||
+      (pRun == NULL) || (pLine == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Set up the line reader and import state */
+  lr.pv = pl;
+  lr.len = aksview_getlen(pl);
+  lr.pBlk = pBlk;
+  lr.pLine = pLine;
+  
+  is.pv = pv;
+  is.flen = flen;
+  is.next = start;
+  is.last_addr = -1;
+  is.pat_addr = -1;
+  is.pRun = pRun;
+  is.pCache = pCache;
+  
+  /* Import each line */
+  while (status) {
+    r = lineRead(&lr);
+    if (r == 0) {
+      break;
+    }
+    
+    if (r < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Listing line ", pModule);
+      fprintInt64(stderr, lr.line_num);
+      fprintf(stderr, " is too long!\n");
+    }
+    
+    if (status) {
+      status = importLine(&is, lr.pLine, lr.line_num);
+    }
+  }
+  
+  /* A collapse marker must not be the last line */
+  if (status && is.star) {
+    status = 0;
+    fprintf(stderr, "%s: Collapse marker at end of listing!\n", pModule);
+  }
+  
+  /* Write out any pending run, and report the span */
+  if (status) {
+    importFlush(&is);
+    if (pSpan != NULL) {
+      pSpan[0] = is.lo;
+      pSpan[1] = is.hi;
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Combine a block of bytes with a pattern of the same length.
+ * 
+ * The operation is selected outside of the loops, so that each loop is
+ * a simple pass over two arrays that the compiler can vectorize.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the block of bytes to transform in place
+ * 
+ *   pPat - the pattern bytes
+ * 
+ *   len - the number of bytes in the block
+ * 
+ *   mode - the transform mode flags
+ */
+static void xformBlock(
+    uint8_t *pBuf,
+    const uint8_t *pPat,
+    int32_t len,
+    int mode) {
+  
+  int32_t i = 0;
+  
+  /* Check parameters */
+  if ((pBuf == NULL) || (pPat == NULL) || (len < 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Apply the operation */
+  if (mode & XFORM_MODE_AND) {
+    for(i = 0; i < len; i++) {
+      pBuf[i] &= pPat[i];
+    }
+    
+  } else if (mode & XFORM_MODE_OR) {
+    for(i = 0; i < len; i++) {
+      pBuf[i] |= pPat[i];
+    }
+    
+  } else {
+    for(i = 0; i < len; i++) {
+      pBuf[i] ^= pPat[i];
+    }
+  }
+}
+
+/*
+ * Parse a chunk layout.
+ * 
+ * The layout is a sequence of items separated by commas, with no
+ * whitespace.  The items are:
+ * 
+ *   len=[type]@[offset] - the type of the length field and its offset
+ *   within the header, which is required
+ * 
+ *   tag=[type]@[offset] - the type of the tag field and its offset
+ *   within the header
+ * 
+ *   head=[count] - the header size, which defaults to just covering the
+ *   fields
+ * 
+ *   tail=[count] - the number of bytes after the payload that are not
+ *   counted by the length field, which defaults to zero
+ * 
+ *   align=[count] - the alignment of chunks relative to the start of
+ *   the walk, which defaults to one
+ * 
+ *   inclusive - the length field counts the header as well as the
+ *   payload
+ * 
+ * Parameters:
+ * 
+ *   pstr - the layout string
+ * 
+ *   pl - the layout structure to fill in
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int parseLayout(const char *pstr, CHUNK_LAYOUT *pl) {
+  
+  int status = 1;
+  int has_head = 0;
+  size_t ilen = 0;
+  int64_t v = 0;
+  int64_t field_end = 0;
+  char *pVal = NULL;
+  char *pOff = NULL;
+  const BINPOKE_TYPE *pt = NULL;
+  char item[CHUNK_MAXITEM + 1];
+  
+  /* Check parameters */
+  if ((pstr == NULL) || (pl == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Set defaults */
+  memset(pl, 0, sizeof(CHUNK_LAYOUT));
+  pl->align = 1;
+  
+  /* Parse each item */
+  while (status) {
+    /* Copy the current item */
+    ilen = strcspn(pstr, ",");
+    if ((ilen < 1) || (ilen > CHUNK_MAXITEM)) {
+      status = 0;
+    } else {
+      memcpy(item, pstr, ilen);
+      item[ilen] = 0;
+    }
+    
+    /* Split off the value, if there is one */
+    if (status) {
+      pVal = strchr(item, '=');
+      if (pVal != NULL) {
+        *pVal = 0;
+        pVal++;
+      }
+    }
+    
+    /* Handle each item */
+    if (status && (strcmp(item, "inclusive") == 0) && (pVal == NULL)) {
+      pl->inclusive = 1;
+      
+    } else if (status && (pVal == NULL)) {
+      status = 0;
+      
+    } else if (status &&
+        ((strcmp(item, "len") == 0) || (strcmp(item, "tag") == 0))) {
+      /* Field with a type and an offset */
+      pOff = strchr(pVal, '@');
+      if (pOff == NULL) {
+        status = 0;
+      } else {
+        *pOff = 0;
+        pOff++;
+      }
+      
+      if (status) {
+        pt = binpoke_parsetype(pVal);
+        v = binpoke_parsecount(pOff);
+        if ((pt == NULL) || (v < 0) || (v > CHUNK_MAXHEAD)) {
+          status = 0;
+        }
+      }
+      
+      if (status && (strcmp(item, "len") == 0)) {
+        pl->pLen = pt;
+        pl->len_off = (int32_t) v;
+      } else if (status) {
+        pl->pTag = pt;
+        pl->tag_off = (int32_t) v;
+      }
+      
+    } else if (status) {
+      /* Item with a count */
+      v = binpoke_parsecount(pVal);
+      if (strcmp(item, "head") == 0) {
+        if ((v < 1) || (v > CHUNK_MAXHEAD)) {
+          status = 0;
+        } else {
+          pl->head = (int32_t) v;
+          has_head = 1;
+        }
+        
+      } else if (strcmp(item, "tail") == 0) {
+        if (v < 0) {
+          status = 0;
+        } else {
+          pl->tail = v;
+        }
+        
+      } else if (strcmp(item, "align") == 0) {
+        if ((v < 1) || (v > CHUNK_MAXALIGN)) {
+          status = 0;
+        } else {
+          pl->align = v;
+        }
+        
+      } else {
+        status = 0;
+      }
+    }
+    
+    /* Leave loop if this was the last item, else skip the comma */
+    if (pstr[ilen] == 0) {
+      break;
+    }
+    pstr += ilen + 1;
+  }
+  
+  /* The length field is required */
+  if (status && (pl->pLen == NULL)) {
+    status = 0;
+  }
+  
+  /* Check that the fields are within the header, or make the header
+   * just cover the fields if no size was given */
+  if (status) {
+    field_end = pl->len_off + pl->pLen->width;
+    if ((pl->pTag != NULL) &&
+        (pl->tag_off + pl->pTag->width > field_end)) {
+      field_end = pl->tag_off + pl->pTag->width;
+    }
+    
+    if (!has_head) {
+      if (field_end > CHUNK_MAXHEAD) {
+        status = 0;
+      } else {
+        pl->head = (int32_t) field_end;
+      }
+      
+    } else if (field_end > pl->head) {
+      status = 0;
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Print one row of a chunk table.
+ * 
+ * The row has the chunk number, the file offset of the chunk, the tag,
+ * and the payload length, separated by tabs.  The tag is printed as its
+ * value in base-16 followed by its bytes in file order as characters in
+ * square brackets, or as "-" if there is no tag.
+ * 
+ * Parameters:
+ * 
+ *   n - the chunk number
+ * 
+ *   offset - the file offset of the chunk
+ * 
+ *   pt - the type of the tag field, or NULL if there is no tag
+ * 
+ *   tag - the value of the tag field
+ * 
+ *   len - the payload length
+ */
+static void printChunk(
+    int64_t n,
+    int64_t offset,
+    const BINPOKE_TYPE *pt,
+    uint64_t tag,
+    int64_t len) {
+  
+  int j = 0;
+  uint8_t tb[8];
+  
+  /* Print the chunk number and offset */
+  printInt64(n);
+  putchar('\t');
+  printInt64(offset);
+  putchar('\t');
+  
+  /* Print the tag */
+  if (pt != NULL) {
+    printf("0x");
+    for(j = pt->width - 1; j >= 0; j--) {
+      printf("%02x", (int) ((tag >> (8 * j)) & 0xff));
+    }
+    
+    binpoke_encode(tb, pt, tag);
+    printf(" [");
+    for(j = 0; j < pt->width; j++) {
+      if ((tb[j] >= 0x20) && (tb[j] <= 0x7e)) {
+        putchar((int) tb[j]);
+      } else {
+        putchar('.');
+      }
+    }
+    putchar(']');
+    
+  } else {
+    putchar('-');
+  }
+  
+  /* Print the payload length */
+  putchar('\t');
+  printInt64(len);
+  printf("\n");
+}
+
+/*
+ * Open the chunk index of a file and check that it is complete and
+ * matches the file length and modification time.
+ * 
+ * An index that was written without a known modification time, because
+ * the file had been modified within MANIFEST_SLACK seconds, is stale
+ * once the time is known, since the file could have changed without
+ * its time changing.  Errors are reported to stderr.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   flen - the length of the file
+ * 
+ *   pCount - receives the number of chunks in the index
+ * 
+ *   ppt - receives the type of the tag field, or NULL if the chunks have
+ *   no tag
+ * 
+ * Return:
+ * 
+ *   a view of the chunk index, or NULL if error
+ */
+static AKSVIEW *chunkOpen(
+    const char *pPath,
+    int64_t flen,
+    int64_t *pCount,
+    const BINPOKE_TYPE **ppt) {
+  
+  int status = 1;
+  int valid = 0;
+  int errcode = 0;
+  int j = 0;
+  int width = 0;
+  int big = 0;
+  uint64_t uv = 0;
+  char *pCPath = NULL;
+  AKSVIEW *pc = NULL;
+  const BINPOKE_TYPE *pt = NULL;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (flen < 0) || (pCount == NULL) ||
+      (ppt == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Open the chunk index */
+  pCPath = sidecarPath(pPath, WALK_SUFFIX);
+  pc = aksview_create(pCPath, AKSVIEW_READONLY, &errcode);
+  if (pc == NULL) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to open chunk index: %s\n",
+              pModule, aksview_errstr(errcode));
+  }
+  
+  /* Check the signature */
+  if (status) {
+    valid = (aksview_getlen(pc) >= WALK_HEADER);
+    for(j = 0; valid && (j < 8); j++) {
+      if (aksview_read8u(pc, j) != (WALK_SIGNATURE)[j]) {
+        valid = 0;
+      }
+    }
+    if (!valid) {
+      status = 0;
+      fprintf(stderr, "%s: Chunk index is incomplete!\n", pModule);
+    }
+  }
+  
+  /* Check that the index matches the file length */
+  if (status) {
+    if (readInt(pc, 8, pSidecarType) != (uint64_t) flen) {
+      status = 0;
+      fprintf(stderr, "%s: Chunk index is stale; file length "
+                "changed!\n", pModule);
+    }
+  }
+  
+  if (status) {
+    if (readInt(pc, 40, pSidecarType) != (uint64_t) fileStamp(pPath)) {
+      status = 0;
+      fprintf(stderr, "%s: Chunk index is stale; file modified!\n",
+                pModule);
+    }
+  }
+  
+  /* Get the chunk count and check the index length */
+  if (status) {
+    uv = readInt(pc, 16, pSidecarType);
+    if (uv > (uint64_t) ((aksview_getlen(pc) - WALK_HEADER) /
+                          WALK_RECORD)) {
+      status = 0;
+      fprintf(stderr, "%s: Chunk index is corrupt!\n", pModule);
+    } else {
+      *pCount = (int64_t) uv;
+    }
+  }
+  
+  /* Get the tag type */
+  if (status) {
+    width = (int) readInt(pc, 24, pSidecarType);
+    big = (int) readInt(pc, 32, pSidecarType);
+    
+    pt = NULL;
+    if (width != 0) {
+      for(j = 0; binpoke_type(j) != NULL; j++) {
+        pt = binpoke_type(j);
+        if ((!(pt->sgn)) && (pt->width == width) &&
+            ((pt->big != 0) == (big != 0))) {
+          break;
+        }
+      }
+      if (binpoke_type(j) == NULL) {
+        status = 0;
+        fprintf(stderr, "%s: Chunk index is corrupt!\n", pModule);
+      }
+    }
+    *ppt = pt;
+  }
+  
+  /* Close the index if error */
+  if ((!status) && (pc != NULL)) {
+    aksview_close(pc);
+    pc = NULL;
+  }
+  
+  /* Release path */
+  free(pCPath);
+  
+  /* Return the index view or NULL */
+  return pc;
+}
+
+/*
+ * Classify a block of bytes as printable or not.
+ * 
+ * Printable bytes are US-ASCII in the range 0x20 to 0x7e, as in a
+ * listing.  The range check is a single unsigned comparison in a simple
+ * pass over two arrays, so that the compiler can vectorize it.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the block of bytes
+ * 
+ *   pFlag - receives one for each printable byte and zero for each other
+ *   byte
+ * 
+ *   len - the number of bytes in the block
+ */
+static void stringsClassify(
+    const uint8_t *pBuf,
+    uint8_t *pFlag,
+    int32_t len) {
+  
+  int32_t i = 0;
+  
+  /* Check parameters */
+  if ((pBuf == NULL) || (pFlag == NULL) || (len < 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Classify each byte */
+  for(i = 0; i < len; i++) {
+    pFlag[i] = (uint8_t) (((uint8_t) (pBuf[i] - 0x20)) < 0x5f);
+  }
+}
+
+/*
+ * Find the end of a span of equal flags from stringsClassify().
+ * 
+ * Eight flags are compared at a time while the span continues, so long
+ * runs and long stretches of binary data are skipped quickly.
+ * 
+ * Parameters:
+ * 
+ *   pFlag - the flags
+ * 
+ *   i - the index of the first flag of the span
+ * 
+ *   len - the number of flags
+ * 
+ *   v - the flag value of the span, either zero or one
+ * 
+ * Return:
+ * 
+ *   the index of the first flag after i that differs from v, or len if
+ *   there is none
+ */
+static int32_t stringsSpan(
+    const uint8_t *pFlag,
+    int32_t i,
+    int32_t len,
+    int v) {
+  
+  uint64_t w = 0;
+  uint64_t pat = 0;
+  
+  /* Check parameters */
+  if ((pFlag == NULL) || (i < 0) || (len < i) ||
+      ((v != 0) && (v != 1))) {
+    fault(__LINE__);
+  }
+  
+  /* Skip whole words of matching flags */
+  if (v) {
+    pat = UINT64_C(0x0101010101010101);
+  }
+  while (len - i >= 8) {
+    memcpy(&w, pFlag + i, 8);
+    if (w != pat) {
+      break;
+    }
+    i += 8;
+  }
+  
+  /* Skip the remaining matching flags one at a time */
+  while ((i < len) && (pFlag[i] == v)) {
+    i++;
+  }
+  
+  /* Return the end of the span */
+  return i;
+}
+
+/*
+ * Find the start of the next run of printable flags from
+ * stringsClassify() that is at least the minimum length.
+ * 
+ * Index i must not be inside a run, which means that it is the start
+ * of the flags or follows a flag that is not printable.  Runs that are
+ * shorter than the minimum are skipped without visiting most of their
+ * flags.  At each candidate start, the flags are checked backwards from
+ * the last one that a long enough run would need, and a flag that is
+ * not printable rules out every start up to it, so that binary data is
+ * passed over up to the minimum length at a time.
+ * 
+ * The search stops early when fewer than the minimum number of flags
+ * remain, since a run there may still continue past the end of the
+ * flags.
+ * 
+ * Parameters:
+ * 
+ *   pFlag - the flags
+ * 
+ *   i - the index to start searching from
+ * 
+ *   len - the number of flags
+ * 
+ *   minlen - the minimum run length, which must be at least one
+ * 
+ * Return:
+ * 
+ *   the index of the start of the next run of at least the minimum
+ *   length, or an index less than the minimum length from the end, or
+ *   len
+ */
+static int32_t stringsSkip(
+    const uint8_t *pFlag,
+    int32_t i,
+    int32_t len,
+    int32_t minlen) {
+  
+  int32_t k = 0;
+  
+  /* Check parameters */
+  if ((pFlag == NULL) || (i < 0) || (len < i) || (minlen < 1)) {
+    fault(__LINE__);
+  }
+  
+  /* Skip to a printable flag, then check backwards whether a long
+   * enough run starts there, and otherwise skip past the flag that is
+   * not printable */
+  for(i = stringsSpan(pFlag, i, len, 0); len - i >= minlen;
+      i = stringsSpan(pFlag, k + 1, len, 0)) {
+    for(k = i + minlen - 1; (k > i) && pFlag[k]; k--);
+    if (k <= i) {
+      break;
+    }
+  }
+  
+  /* Return the index */
+  return i;
+}
+
+/*
+ * Mix one word into one lane of a block hash.
+ * 
+ * Parameters:
+ * 
+ *   acc - the lane
+ * 
+ *   w - the word
+ * 
+ * Return:
+ * 
+ *   the new value of the lane
+ */
+static uint64_t hashRound(uint64_t acc, uint64_t w) {
+  acc += w * HASH_PRIME2;
+  acc = (acc << 31) | (acc >> 33);
+  return acc * HASH_PRIME1;
+}
+
+/*
+ * Get the 8-byte word at a given position in the data of a block hash.
+ * 
+ * Words are little endian on every platform, so that hashes recorded
+ * on one platform can be checked on another.
+ * 
+ * Parameters:
+ * 
+ *   pBytes - the first byte of the word
+ * 
+ * Return:
+ * 
+ *   the word
+ */
+static uint64_t hashWord(const uint8_t *pBytes) {
+  return ((uint64_t) pBytes[0]) |
+          (((uint64_t) pBytes[1]) << 8) |
+          (((uint64_t) pBytes[2]) << 16) |
+          (((uint64_t) pBytes[3]) << 24) |
+          (((uint64_t) pBytes[4]) << 32) |
+          (((uint64_t) pBytes[5]) << 40) |
+          (((uint64_t) pBytes[6]) << 48) |
+          (((uint64_t) pBytes[7]) << 56);
+}
+
+/*
+ * Start a block hash.
+ * 
+ * Parameters:
+ * 
+ *   pb - the block hash
+ */
+static void hashStart(BLOCK_HASH *pb) {
+  
+  /* Check parameter */
+  if (pb == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Seed the lanes */
+  pb->v[0] = HASH_PRIME1 + HASH_PRIME2;
+  pb->v[1] = HASH_PRIME2;
+  pb->v[2] = 0;
+  pb->v[3] = 0 - HASH_PRIME1;
+  pb->len = 0;
+}
+
+/*
+ * Add data to a block hash.
+ * 
+ * Every call except the last for a given hash must add a multiple of 32
+ * bytes, so that the lanes stay in step.
+ * 
+ * Parameters:
+ * 
+ *   pb - the block hash
+ * 
+ *   pBuf - the data
+ * 
+ *   len - the number of bytes of data
+ */
+static void hashUpdate(BLOCK_HASH *pb, const uint8_t *pBuf, int32_t len) {
+  
+  int32_t i = 0;
+  int32_t j = 0;
+  int k = 0;
+  uint64_t w = 0;
+  uint64_t v0 = 0;
+  uint64_t v1 = 0;
+  uint64_t v2 = 0;
+  uint64_t v3 = 0;
+  
+  /* Check parameters and state */
+  if ((pb == NULL) || (pBuf == NULL) || (len < 0) ||
+      ((pb->len % 32) != 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Mix each whole stripe of four words into the four lanes, which are
+   * kept in locals so the compiler can overlap the lanes */
+  v0 = pb->v[0];
+  v1 = pb->v[1];
+  v2 = pb->v[2];
+  v3 = pb->v[3];
+  for(i = 0; len - i >= 32; i += 32) {
+    v0 = hashRound(v0, hashWord(pBuf + i));
+    v1 = hashRound(v1, hashWord(pBuf + i + 8));
+    v2 = hashRound(v2, hashWord(pBuf + i + 16));
+    v3 = hashRound(v3, hashWord(pBuf + i + 24));
+  }
+  pb->v[0] = v0;
+  pb->v[1] = v1;
+  pb->v[2] = v2;
+  pb->v[3] = v3;
+  
+  /* Mix any remaining whole words, and then any remaining bytes as one
+   * last partial word, into the lanes in turn */
+  for(k = 0; len - i >= 8; i += 8) {
+    pb->v[k] = hashRound(pb->v[k], hashWord(pBuf + i));
+    k++;
+  }
+  if (i < len) {
+    w = 0;
+    for(j = 0; i + j < len; j++) {
+      w |= ((uint64_t) pBuf[i + j]) << (8 * j);
+    }
+    pb->v[k] = hashRound(pb->v[k], w);
+  }
+  
+  pb->len += len;
+}
+
+/*
+ * Get the result of a block hash.
+ * 
+ * Parameters:
+ * 
+ *   pb - the block hash
+ * 
+ * Return:
+ * 
+ *   the hash of all the data added
+ */
+static uint64_t hashFinish(const BLOCK_HASH *pb) {
+  
+  uint64_t h = 0;
+  
+  /* Check parameter */
+  if (pb == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Combine the lanes with the length, and mix the bits thoroughly */
+  h = ((pb->v[0] << 1) | (pb->v[0] >> 63)) +
+      ((pb->v[1] << 7) | (pb->v[1] >> 57)) +
+      ((pb->v[2] << 12) | (pb->v[2] >> 52)) +
+      ((pb->v[3] << 18) | (pb->v[3] >> 46));
+  h ^= (uint64_t) pb->len;
+  
+  h ^= h >> 33;
+  h *= HASH_PRIME2;
+  h ^= h >> 29;
+  h *= HASH_PRIME3;
+  h ^= h >> 32;
+  
+  /* Return result */
+  return h;
+}
+
+/*
+ * Compute the block hash of a range of a file.
+ * 
+ * The range is streamed through a buffer of BLOCK_SIZE bytes.  Parts of
+ * the range that the hole map finds to be holes are hashed as zero
+ * bytes without being read, and a range that is one whole hole reuses
+ * the hash remembered in the hole map if it has the same length.  The
+ * caller must ensure that the range is within the file limits.
+ * 
+ * Parameters:
+ * 
+ *   pv - the view of the file
+ * 
+ *   ph - the hole map of the file
+ * 
+ *   pc - the cache dropper of the file
+ * 
+ *   pos - the file offset of the range
+ * 
+ *   len - the length of the range
+ * 
+ *   pBuf - a buffer of BLOCK_SIZE bytes
+ * 
+ * Return:
+ * 
+ *   the hash of the range
+ */
+static uint64_t hashRange(
+    AKSVIEW *pv,
+    HOLE_MAP *ph,
+    CACHE_DROP *pc,
+    int64_t pos,
+    int64_t len,
+    uint8_t *pBuf) {
+  
+  int whole = 0;
+  int64_t p = 0;
+  int32_t blen = 0;
+  uint64_t h = 0;
+  BLOCK_HASH bh;
+  
+  /* Check parameters */
+  if ((pv == NULL) || (ph == NULL) || (pc == NULL) || (pos < 0) ||
+      (len < 0) || (pBuf == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Reuse the remembered hash if the range is one whole hole of the
+   * same length */
+  if (len > 0) {
+    whole = holeCheck(ph, pos, len);
+  }
+  if (whole && (ph->zero_len == len)) {
+    h = ph->zero_hash;
+    
+  } else {
+    /* Hash each block of the range */
+    hashStart(&bh);
+    for(p = pos; p < pos + len; p += blen) {
+      if (pos + len - p < BLOCK_SIZE) {
+        blen = (int32_t) (pos + len - p);
+      } else {
+        blen = BLOCK_SIZE;
+      }
+      
+      if (holeCheck(ph, p, blen)) {
+        memset(pBuf, 0, (size_t) blen);
+      } else {
+        readBlock(pv, p, pBuf, blen);
+        cacheDrop(pc, p, blen);
+      }
+      hashUpdate(&bh, pBuf, blen);
+    }
+    h = hashFinish(&bh);
+    
+    /* Remember the hash of a whole hole */
+    if (whole) {
+      ph->zero_len = len;
+      ph->zero_hash = h;
+    }
+  }
+  
+  /* Return the hash */
+  return h;
+}
+
+/*
+ * Add one record of an undo journal to the checksum of its records.
+ * 
+ * The checksum starts at zero, and each record is added in turn, so
+ * that records that are missing, zeroed, or out of order all change
+ * it.
+ * 
+ * Parameters:
+ * 
+ *   acc - the checksum of the records before this one
+ * 
+ *   pRec - the record of JOURNAL_RECORD bytes
+ * 
+ * Return:
+ * 
+ *   the checksum including this record
+ */
+static uint64_t journalSum(uint64_t acc, const uint8_t *pRec) {
+  
+  BLOCK_HASH bh;
+  
+  /* Check parameter */
+  if (pRec == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Hash the record and mix the hash into the checksum */
+  hashStart(&bh);
+  hashUpdate(&bh, pRec, JOURNAL_RECORD);
+  return hashRound(acc, hashFinish(&bh));
+}
+
+/*
+ * Get the length of a block of a file, which is the block size for
+ * every block but the last.
+ * 
+ * Parameters:
+ * 
+ *   n - the index of the block
+ * 
+ *   bsize - the block size
+ * 
+ *   flen - the length of the file
+ * 
+ * Return:
+ * 
+ *   the length of the block, which is zero or less if the block is
+ *   beyond the end of the file
+ */
+static int64_t blockLen(int64_t n, int64_t bsize, int64_t flen) {
+  
+  int64_t result = 0;
+  
+  /* Check parameters */
+  if ((n < 0) || (bsize < 1) || (flen < 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Clip the block to the end of the file */
+  result = flen - (n * bsize);
+  if (result > bsize) {
+    result = bsize;
+  }
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Open a pool of workers to hash the blocks of a file.
+ * 
+ * The first worker borrows the given view and always exists.  When
+ * compiled with BINPOKE_THREADS, one further worker is added for each
+ * other online processor, up to HASH_MAXWORKERS and the number of
+ * blocks in the file.  Each further worker opens its own read-only view
+ * of the file.  A further worker whose view cannot be opened, or whose
+ * buffer would not fit in the memory budget, is simply left out.
+ * 
+ * The pool must be closed with hashPoolClose() even if this function
+ * fails.
+ * 
+ * Parameters:
+ * 
+ *   pp - the pool to open
+ * 
+ *   pv - the view of the file
+ * 
+ *   pPath - the path to the file
+ * 
+ *   nocache - non-zero to drop the file from the page cache as it is
+ *   read
+ * 
+ *   bsize - the block size
+ * 
+ *   flen - the length of the file
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if the memory budget is exceeded
+ */
+static int hashPoolOpen(
+    HASH_POOL *pp,
+    AKSVIEW *pv,
+    const char *pPath,
+    int nocache,
+    int64_t bsize,
+    int64_t flen) {
+  
+  int status = 1;
+  int errcode = 0;
+  int want = 1;
+  int i = 0;
+  int64_t room = 0;
+  AKSVIEW *pw = NULL;
+  HASH_WORKER *pk = NULL;
+  
+  /* Check parameters */
+  if ((pp == NULL) || (pv == NULL) || (pPath == NULL) || (bsize < 1) ||
+      (flen < 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Initialize structure */
+  memset(pp, 0, sizeof(HASH_POOL));
+  for(i = 0; i < HASH_MAXWORKERS; i++) {
+    pp->w[i].hm.fd = -1;
+    pp->w[i].cd.fd = -1;
+  }
+  
+  /* Use a worker for each online processor, but no more than there are
+   * blocks */
+#ifdef BINPOKE_THREADS
+  want = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if (want > HASH_MAXWORKERS) {
+    want = HASH_MAXWORKERS;
+  }
+  if ((int64_t) want > (flen / bsize) + ((flen % bsize) != 0)) {
+    want = (int) ((flen / bsize) + ((flen % bsize) != 0));
+  }
+  if (want < 1) {
+    want = 1;
+  }
+#endif
+  
+  /* Open each worker, leaving out further workers that do not fit */
+  for(i = 0; i < want; i++) {
+    pk = &(pp->w[i]);
+    pw = pv;
+    if (i > 0) {
+      room = bufRoom();
+      if ((room >= 0) && (room < BLOCK_SIZE)) {
+        break;
+      }
+      pw = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
+      if (pw == NULL) {
+        break;
+      }
+      pk->owned = 1;
+    }
+    pk->pv = pw;
+    
+    pk->pBuf = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    if (pk->pBuf == NULL) {
+      if (i < 1) {
+        status = 0;
+      }
+      if (pk->owned) {
+        aksview_close(pw);
+      }
+      pk->pv = NULL;
+      pk->owned = 0;
+      break;
+    }
+    
+    cacheOpen(&(pk->cd), pPath, nocache);
+    holeOpen(&(pk->hm), pPath);
+    pk->bsize = bsize;
+    pk->flen = flen;
+    pp->count++;
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Hash the share of the current round of one worker.
+ * 
+ * This is the entry point of the worker threads, so it only touches the
+ * worker and the slots of the round that belong to its share.
+ * 
+ * Parameters:
+ * 
+ *   pArg - the worker
+ * 
+ * Return:
+ * 
+ *   NULL
+ */
+static void *hashWork(void *pArg) {
+  
+  int64_t n = 0;
+  int64_t blen = 0;
+  HASH_WORKER *pk = NULL;
+  
+  /* Check parameter */
+  if (pArg == NULL) {
+    fault(__LINE__);
+  }
+  pk = (HASH_WORKER *) pArg;
+  
+  /* Hash each needed block of the share */
+  for(n = pk->first; n < pk->last; n++) {
+    if (pk->pNeed[n - pk->base]) {
+      blen = blockLen(n, pk->bsize, pk->flen);
+      pk->pHash[n - pk->base] = hashRange(pk->pv, &(pk->hm), &(pk->cd),
+                                      n * pk->bsize, blen, pk->pBuf);
+    }
+  }
+  
+  /* Return nothing */
+  return NULL;
+}
+
+/*
+ * Hash the needed blocks of one round.
+ * 
+ * The need array of the pool must be filled in for the blocks of the
+ * round before calling.  Each worker hashes a share of up to HASH_ROUND
+ * consecutive blocks, and the first share is hashed on the calling
+ * thread.  A share whose thread cannot be started is also hashed on the
+ * calling thread.  This function returns once every share is hashed.
+ * 
+ * Parameters:
+ * 
+ *   pp - the pool
+ * 
+ *   base - the index of the first block of the round
+ * 
+ *   end - the index of the block after the round, which must not be
+ *   more than HASH_ROUND blocks per worker past base
+ */
+static void hashPoolRun(HASH_POOL *pp, int64_t base, int64_t end) {
+  
+  int i = 0;
+  HASH_WORKER *pk = NULL;
+  
+  /* Check parameters */
+  if ((pp == NULL) || (pp->count < 1) || (base < 0) || (end < base) ||
+      (end - base > ((int64_t) pp->count) * HASH_ROUND)) {
+    fault(__LINE__);
+  }
+  
+  /* Give each worker its share */
+  for(i = 0; i < pp->count; i++) {
+    pk = &(pp->w[i]);
+    pk->base = base;
+    pk->first = base + (((int64_t) i) * HASH_ROUND);
+    pk->last = pk->first + HASH_ROUND;
+    if (pk->first > end) {
+      pk->first = end;
+    }
+    if (pk->last > end) {
+      pk->last = end;
+    }
+    pk->pNeed = pp->need;
+    pk->pHash = pp->hash;
+  }
+  
+  /* Start the further workers that have a share, hash the first share
+   * here, and then wait for the others */
+#ifdef BINPOKE_THREADS
+  for(i = 1; i < pp->count; i++) {
+    pk = &(pp->w[i]);
+    pk->started = 0;
+    if (pk->first < pk->last) {
+      pk->started = (pthread_create(&(pk->thread), NULL,
+                                      &hashWork, pk) == 0);
+    }
+  }
+#endif
+  
+  hashWork(&(pp->w[0]));
+  
+  for(i = 1; i < pp->count; i++) {
+    pk = &(pp->w[i]);
+#ifdef BINPOKE_THREADS
+    if (pk->started) {
+      pthread_join(pk->thread, NULL);
+      pk->started = 0;
+    } else {
+      hashWork(pk);
+    }
+#else
+    hashWork(pk);
+#endif
+  }
+}
+
+/*
+ * Close a pool of hash workers, releasing their buffers and closing
+ * the views that they opened.  A pool that is all zero, because it was
+ * never opened, is left as it is.
+ * 
+ * Call this after the view given to hashPoolOpen() has been closed, in
+ * the same way as cacheClose().
+ * 
+ * Parameters:
+ * 
+ *   pp - the pool
+ */
+static void hashPoolClose(HASH_POOL *pp) {
+  
+  int i = 0;
+  HASH_WORKER *pk = NULL;
+  
+  /* Check parameter */
+  if (pp == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Close the workers in the reverse order of their buffers, closing
+   * the views before the cache droppers */
+  for(i = pp->count - 1; i >= 0; i--) {
+    pk = &(pp->w[i]);
+    bufFree(pk->pBuf);
+    pk->pBuf = NULL;
+    if (pk->owned) {
+      aksview_close(pk->pv);
+      pk->owned = 0;
+    }
+    pk->pv = NULL;
+    cacheClose(&(pk->cd));
+    holeClose(&(pk->hm));
+  }
+  pp->count = 0;
+}
+
+/*
+ * Get the modification time of a file to record in a block manifest.
+ * 
+ * The time is only known on POSIX platforms.  A time within
+ * MANIFEST_SLACK seconds of the current time is not returned, since the
+ * file could be modified again without its time changing.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ * Return:
+ * 
+ *   the modification time in seconds since the epoch, or zero if it is
+ *   not known or too recent
+ */
+static int64_t fileStamp(const char *pPath) {
+  
+  int64_t result = 0;
+#ifndef AKS_WIN
+  time_t now = 0;
+  struct stat st;
+#endif
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Get the modification time, if it is old enough */
+#ifndef AKS_WIN
+  if (stat(pPath, &st) == 0) {
+    now = time(NULL);
+    if ((st.st_mtime > 0) && (now != ((time_t) -1)) &&
+        (st.st_mtime < now - MANIFEST_SLACK)) {
+      result = (int64_t) st.st_mtime;
+    }
+  }
+#endif
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Find the end of a run of pages that are all the same, or all
+ * different, in the source and destination blocks of the mirror verb.
+ * 
+ * Pages are MIRROR_PAGE bytes long, counting from the start of the
+ * blocks, except that the last page may be shorter.  Each page is
+ * compared with memcmp(), which the C library vectorizes.
+ * 
+ * Parameters:
+ * 
+ *   pSrc - the source block
+ * 
+ *   pDst - the destination block
+ * 
+ *   i - the offset of the page that starts the run, which must be a
+ *   multiple of MIRROR_PAGE or else equal to len
+ * 
+ *   len - the length of both blocks
+ * 
+ *   same - non-zero for a run of pages that are the same, zero for a run
+ *   of pages that differ
+ * 
+ * Return:
+ * 
+ *   the offset just after the end of the run, which is i if the page at
+ *   i does not belong to the run
+ */
+static int32_t mirrorSpan(
+    const uint8_t *pSrc,
+    const uint8_t *pDst,
+    int32_t i,
+    int32_t len,
+    int same) {
+  
+  int32_t n = 0;
+  
+  /* Check parameters */
+  if ((pSrc == NULL) || (pDst == NULL) || (i < 0) || (i > len) ||
+      (((i % MIRROR_PAGE) != 0) && (i < len))) {
+    fault(__LINE__);
+  }
+  
+  /* Go through the pages while they belong to the run */
+  same = (same != 0);
+  for( ; i < len; i += n) {
+    if (len - i < MIRROR_PAGE) {
+      n = len - i;
+    } else {
+      n = MIRROR_PAGE;
+    }
+    if ((memcmp(pSrc + i, pDst + i, (size_t) n) == 0) != same) {
+      break;
+    }
+  }
+  
+  /* Return the end of the run */
+  return i;
+}
+
+/*
+ * Open the block manifest of a file and check it.
+ * 
+ * Errors are reported to stderr.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   writable - non-zero to open the manifest for reading and writing,
+ *   zero to open it only for reading
+ * 
+ *   pLen - receives the length of the file when the manifest was written
+ * 
+ *   pBlock - receives the block size
+ * 
+ *   pStamp - receives the recorded modification time, or zero if none
+ * 
+ * Return:
+ * 
+ *   the view of the manifest, or NULL if error
+ */
+static AKSVIEW *manifestOpen(
+    const char *pPath,
+    int writable,
+    int64_t *pLen,
+    int64_t *pBlock,
+    int64_t *pStamp) {
+  
+  int status = 1;
+  int valid = 0;
+  int errcode = 0;
+  int j = 0;
+  uint64_t flen = 0;
+  uint64_t bsize = 0;
+  uint64_t count = 0;
+  char *pMPath = NULL;
+  AKSVIEW *pm = NULL;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pLen == NULL) || (pBlock == NULL) ||
+      (pStamp == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Open the manifest */
+  pMPath = sidecarPath(pPath, MANIFEST_SUFFIX);
+  if (writable) {
+    pm = aksview_create(pMPath, AKSVIEW_EXISTING, &errcode);
+  } else {
+    pm = aksview_create(pMPath, AKSVIEW_READONLY, &errcode);
+  }
+  if (pm == NULL) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to open block manifest: %s\n",
+              pModule, aksview_errstr(errcode));
+  }
+  
+  /* Check the signature */
+  if (status) {
+    valid = (aksview_getlen(pm) >= MANIFEST_HEADER);
+    for(j = 0; valid && (j < 8); j++) {
+      if (aksview_read8u(pm, j) != (MANIFEST_SIGNATURE)[j]) {
+        valid = 0;
+      }
+    }
+    if (!valid) {
+      status = 0;
+      fprintf(stderr, "%s: Block manifest is incomplete!\n", pModule);
+    }
+  }
+  
+  /* Get the file length and block size, and check that the manifest
+   * has one record for each block */
+  if (status) {
+    flen = readInt(pm, 8, pSidecarType);
+    bsize = readInt(pm, 16, pSidecarType);
+    if ((flen > (uint64_t) INT64_MAX) ||
+        (bsize < BLOCK_SIZE) || (bsize > (uint64_t) MANIFEST_MAXBLOCK) ||
+        ((bsize % BLOCK_SIZE) != 0)) {
+      status = 0;
+    } else {
+      count = (flen / bsize) + ((flen % bsize) != 0);
+      if (aksview_getlen(pm) != MANIFEST_HEADER +
+                                  ((int64_t) count) * MANIFEST_RECORD) {
+        status = 0;
+      }
+    }
+    if (!status) {
+      fprintf(stderr, "%s: Block manifest is corrupt!\n", pModule);
+    }
+  }
+  
+  /* Get the modification time */
+  if (status) {
+    *pLen = (int64_t) flen;
+    *pBlock = (int64_t) bsize;
+    *pStamp = (int64_t) (readInt(pm, 24, pSidecarType) &
+                          ((uint64_t) INT64_MAX));
+  }
+  
+  /* Close the manifest if error */
+  if ((!status) && (pm != NULL)) {
+    aksview_close(pm);
+    pm = NULL;
+  }
+  
+  /* Release path */
+  free(pMPath);
+  
+  /* Return the manifest view or NULL */
+  return pm;
+}
+
+/*
+ * Print a hex dump listing of a range of bytes within a byte source.
+ * 
+ * The caller must ensure that the range is within the file limits.
+ * Errors are reported to stderr, and the listing stops at the first
+ * error.
+ * 
+ * Parameters:
+ * 
+ *   ps - the byte source to list from
+ * 
+ *   pc - the cache dropper that each listed range is recorded with
+ * 
+ *   addr - the file offset of the first byte to list
+ * 
+ *   count - the number of bytes to list, which must be at least one
+ * 
+ *   mode - the listing mode flags
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int listRange(
+    BYTE_SOURCE *ps,
+    CACHE_DROP *pc,
+    int64_t addr,
+    int64_t count,
+    int mode) {
+  
+  int status = 1;
+  int i = 0;
+  int64_t p = 0;
+  int64_t p_first = 0;
+  int64_t p_last = 0;
+  int64_t lo = 0;
+  int64_t hi = 0;
+  
+  int has_prev = 0;
+  int starred = 0;
+  
+  uint8_t buf[16];
+  LIST_LINE ls;
+  LIST_LINE prev;
+  
+  /* Initialize structures */
+  memset(&ls, 0, sizeof(LIST_LINE));
+  memset(&prev, 0, sizeof(LIST_LINE));
+  
+  /* Check parameters */
+  if ((ps == NULL) || (pc == NULL) || (addr < 0) || (count < 1)) {
+    fault(__LINE__);
+  }
+  
+  /* Compute the first and last paragraph addresses that will be
+   * displayed in the listing */
+  p_first = addr / 16;
+  p_last  = (addr + count - 1) / 16;
+  
+  p_first *= 16;
+  p_last  *= 16;
+  
+  /* Print a listing of each paragraph */
+  for(p = p_first; status && (p <= p_last); p += 16) {
+  
+    /* Write the paragraph number into the structure */
+    ls.para = (int32_t) ((p & INT64_C(0xffffffff)) / 16);
+    
+    /* Determine the part of the paragraph within the requested range
+     * and read it */
+    lo = p;
+    hi = p + 16;
+    if (lo < addr) {
+      lo = addr;
+    }
+    if (hi > addr + count) {
+      hi = addr + count;
+    }
+    
+    status = sourceRead(ps, lo, buf, (int32_t) (hi - lo));
+    if (!status) {
+      break;
+    }
+    cacheDrop(pc, lo, hi - lo);
+    
+    /* Store each relevant byte, filling -1 for bytes outside the
+     * requested range */
+    for(i = 0; i < 16; i++) {
+      if (((p + ((int64_t) i)) >= lo) &&
+            ((p + ((int64_t) i)) < hi)) {
+        /* Byte is in range */
+        (ls.bv)[i] = (int) buf[(p + ((int64_t) i)) - lo];
+        
+      } else {
+        /* Byte is not in range */
+        (ls.bv)[i] = -1;
+      }
+    }
+  
+    /* In collapse mode, a paragraph that is identical to the one
+     * before it is replaced by a single "*" marker for the whole run of
+     * repeats; the last paragraph is always printed so that the end of
+     * the range is visible */
+    if ((mode & LIST_MODE_COLLAPSE) && has_prev && (p < p_last) &&
+        (memcmp(ls.bv, prev.bv, sizeof(ls.bv)) == 0)) {
+      if (!starred) {
+        printf("*\n");
+        starred = 1;
+      }
+      
+    } else {
+      /* Print the listing line */
+      printListLine(&ls);
+      starred = 0;
+    }
+    
+    /* Remember this paragraph for comparison with the next */
+    memcpy(&prev, &ls, sizeof(LIST_LINE));
+    has_prev = 1;
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to generate a hex dump listing.
+ * 
+ * In follow mode, after the requested range has been listed, the file
+ * is checked repeatedly for growth and any appended bytes are listed as
+ * they arrive, resuming from the end of the previous listing.  Each
+ * check only looks up the file length, and the view is reopened when
+ * the file has grown so that it covers the new bytes.  This continues
+ * until the program is interrupted or an error occurs.
+ * 
+ * In gzip mode, the path is a gzip file, and the addresses are offsets
+ * within its uncompressed contents.
+ * 
+ * Parameters:
+ * 
+ *   pPath - path to the file
+ * 
+ *   pFrom - string parameter with starting address
+ * 
+ *   pFor - string parameter with byte count
+ * 
+ *   pIn - string parameter with the listing mode, or NULL for the
+ *   default mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_list(
+    const char *pPath,
+    const char *pFrom,
+    const char *pFor,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  BINPOKE *pb = NULL;
+  
+  int64_t addr = 0;
+  int64_t count = 0;
+  int mode = 0;
+  
+  int64_t next = 0;
+  int64_t flen = 0;
+  int32_t delay = 0;
+  
+  EDIT_SESSION es;
+  BYTE_SOURCE src;
+  CACHE_DROP cd;
+  RANGE_LOCK lk;
+  FILE_WATCH fw;
+#ifdef BINPOKE_GZIP
+  GZ_READER gz;
+#endif
+  
+  /* Initialize structures */
+  memset(&es, 0, sizeof(EDIT_SESSION));
+  memset(&src, 0, sizeof(BYTE_SOURCE));
+  memset(&cd, 0, sizeof(CACHE_DROP));
+  cd.fd = -1;
+  lk.fd = -1;
+  fw.fd = -1;
+#ifdef BINPOKE_GZIP
+  memset(&gz, 0, sizeof(GZ_READER));
+#endif
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pFrom == NULL) || (pFor == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the address */
+  addr = binpoke_parseaddress(pFrom);
+  if (addr < 0) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to parse address: %s\n",
+              pModule, pFrom);
+  }
+  
+  /* Get the mode, if provided */
+  if (status && (pIn != NULL)) {
+    mode = parseMode(pIn, listModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse listing mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Get the count */
+  if (status) {
+    count = binpoke_parsecount(pFor);
+    if (count < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse count: %s\n",
+                pModule, pFor);
+    }
+  }
+  
+  /* Check that count is at least one and does not exceed limit */
+  if (status && (count < 1)) {
+    status = 0;
+    fprintf(stderr, "%s: Count may not be less than one!\n", pModule);
+  }
+  
+  if (status && (count > LIST_MAXBYTES)) {
+    status = 0;
+    fprintf(stderr, "%s: Count exceeds LIST_MAXBYTES limit!\n",
+              pModule);
+  }
+  
+  /* Follow mode can not see through an edit session */
+  if (status && (mode & LIST_MODE_FOLLOW) && (mode & LIST_MODE_SESSION)) {
+    status = 0;
+    fprintf(stderr, "%s: Can't follow a file in an edit session!\n",
+              pModule);
+  }
+  
+  /* Gzip mode can not be combined with following or sessions */
+  if (status && (mode & LIST_MODE_GZIP) &&
+      (mode & (LIST_MODE_FOLLOW | LIST_MODE_SESSION))) {
+    status = 0;
+    fprintf(stderr, "%s: Can't follow or edit a gzip file!\n",
+              pModule);
+  }
+  
+  /* Load the edit session, open the gzip reader, or open a read-only
+   * view, and get the file length */
+  if (status && (mode & LIST_MODE_SESSION)) {
+    status = sessionLoad(&es, pPath, AKSVIEW_READONLY);
+    if (status) {
+      src.pe = &es;
+      flen = es.len;
+    }
+    
+  } else if (status && (mode & LIST_MODE_GZIP)) {
+#ifdef BINPOKE_GZIP
+    status = gzOpen(&gz, pPath);
+    if (status) {
+      src.pz = &gz;
+      flen = gz.len;
+    }
+#else
+    fault(__LINE__);
+#endif
+    
+  } else if (status) {
+    pb = binpoke_open(pPath, BINPOKE_READONLY, &errcode);
+    if (pb == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, binpoke_errstr(errcode));
+    } else {
+      src.pb = pb;
+      flen = binpoke_getlen(pb);
+    }
+  }
+  
+  /* Check that address is within file limits */
+  if (status) {
+    if (addr >= flen) {
+      status = 0;
+      fprintf(stderr, "%s: Given address is outside file limits!\n",
+                pModule);
+    }
+  }
+  
+  /* Check that address added to count does not exceed file length */
+  if (status) {
+    if (addr + count > flen) {
+      status = 0;
+      fprintf(stderr, "%s: Given byte range goes beyond end of file!\n",
+                pModule);
+    }
+  }
+  
+  /* Lock the range for reading, unless following, since a follower
+   * must not hold up the writer it is following */
+  if (status && (pb != NULL) && (!(mode & LIST_MODE_FOLLOW))) {
+    status = lockRange(&lk, pPath, addr, count, 0,
+                        mode & LOCK_MODE_WAIT);
+  }
+  
+  /* Print the listing, dropping cached pages behind it only when the
+   * file itself is listed, since the offsets of a session or a gzip
+   * file are not file offsets */
+  if (status) {
+    cacheOpen(&cd, pPath, (pb != NULL) && (mode & SCAN_MODE_NOCACHE));
+    status = listRange(&src, &cd, addr, count, mode);
+  }
+  
+  /* In follow mode, list appended bytes as they arrive; the length is
+   * polled without a view, and the view is only reopened when the file
+   * has grown, so that it covers the new bytes */
+  if (status && (mode & LIST_MODE_FOLLOW)) {
+    next = addr + count;
+    delay = FOLLOW_MINDELAY;
+    fflush(stdout);
+    watchOpen(&fw, pPath);
+    
+    while (status) {
+      /* Wait for the file to change, or until the delay runs out */
+      watchWait(&fw, delay);
+      
+      /* Get the current length */
+      flen = fileLength(pPath);
+      if (flen < 0) {
+        status = 0;
+        fprintf(stderr, "%s: File disappeared while following!\n",
+                  pModule);
+        
+      } else if (flen < next) {
+        status = 0;
+        fprintf(stderr, "%s: File was truncated while following!\n",
+                  pModule);
+      }
+      
+      /* Reopen the view and list any new bytes, and adapt the delay */
+      if (status && (flen > next)) {
+        binpoke_close(pb);
+        pb = binpoke_open(pPath, BINPOKE_READONLY, &errcode);
+        if (pb == NULL) {
+          status = 0;
+          fprintf(stderr, "%s: Failed to open file: %s\n",
+                    pModule, binpoke_errstr(errcode));
+        }
+        
+        if (status) {
+          src.pb = pb;
+          status = listRange(&src, &cd, next, flen - next, mode);
+          fflush(stdout);
+          next = flen;
+          delay = FOLLOW_MINDELAY;
+        }
+        
+      } else if (status && (delay < FOLLOW_MAXDELAY / 2)) {
+        delay *= 2;
+        
+      } else if (status) {
+        delay = FOLLOW_MAXDELAY;
+      }
+    }
+    
+    watchClose(&fw);
+  }
+  
+  /* Release session, readers, and locks, and close viewer and cache
+   * dropper if open */
+  sessionFree(&es);
+#ifdef BINPOKE_GZIP
+  gzClose(&gz);
+#endif
+  binpoke_close(pb);
+  cacheClose(&cd);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to read an integer value from a file.
+ * 
+ * In gzip mode, the path is a gzip file, and the address is an offset
+ * within its uncompressed contents.
+ * 
+ * Parameters:
+ * 
+ *   pPath - path to the file
+ * 
+ *   pAt - string parameter with the address of the integer
+ * 
+ *   pAs - string parameter with the integer type
+ * 
+ *   pIn - string parameter with the editing mode, or NULL for the
+ *   default mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_read(
+    const char *pPath,
+    const char *pAt,
+    const char *pAs,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  BINPOKE *pb = NULL;
+  
+  int64_t addr = 0;
+  int64_t flen = 0;
+  int mode = 0;
+  const BINPOKE_TYPE *pt = NULL;
+  uint8_t buf[8];
+  
+  EDIT_SESSION es;
+  BYTE_SOURCE src;
+  RANGE_LOCK lk;
+#ifdef BINPOKE_GZIP
+  GZ_READER gz;
+#endif
+  
+  /* Initialize structures */
+  memset(&es, 0, sizeof(EDIT_SESSION));
+  memset(&src, 0, sizeof(BYTE_SOURCE));
+  lk.fd = -1;
+#ifdef BINPOKE_GZIP
+  memset(&gz, 0, sizeof(GZ_READER));
+#endif
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pAt == NULL) || (pAs == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the address */
+  addr = binpoke_parseaddress(pAt);
+  if (addr < 0) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to parse address: %s\n",
+              pModule, pAt);
+  }
+  
+  /* Get the type */
+  if (status) {
+    pt = binpoke_parsetype(pAs);
+    if (pt == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Unrecognized type: %s\n", pModule, pAs);
+    }
+  }
+  
+  /* Get the mode, if provided */
+  if (status && (pIn != NULL)) {
+    mode = parseMode(pIn, readModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse editing mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* A gzip file can not have an edit session */
+  if (status && (mode & EDIT_MODE_SESSION) && (mode & EDIT_MODE_GZIP)) {
+    status = 0;
+    fprintf(stderr, "%s: Can't edit a gzip file!\n", pModule);
+  }
+  
+  /* Load the edit session, open the gzip reader, or open a read-only
+   * view, and get the file length */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    status = sessionLoad(&es, pPath, AKSVIEW_READONLY);
+    if (status) {
+      src.pe = &es;
+      flen = es.len;
+    }
+    
+  } else if (status && (mode & EDIT_MODE_GZIP)) {
+#ifdef BINPOKE_GZIP
+    status = gzOpen(&gz, pPath);
+    if (status) {
+      src.pz = &gz;
+      flen = gz.len;
+    }
+#else
+    fault(__LINE__);
+#endif
+    
+  } else if (status) {
+    pb = binpoke_open(pPath, BINPOKE_READONLY, &errcode);
+    if (pb == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, binpoke_errstr(errcode));
+    } else {
+      src.pb = pb;
+      flen = binpoke_getlen(pb);
+    }
+  }
+  
+  /* Check that all bytes of the integer are within file limits */
+  if (status) {
+    if (addr > flen - pt->width) {
+      status = 0;
+      fprintf(stderr, "%s: Given address is outside file limits!\n",
+                pModule);
+    }
+  }
+  
+  /* Lock the bytes of the integer for reading */
+  if (status && (pb != NULL)) {
+    status = lockRange(&lk, pPath, addr, pt->width, 0,
+                        mode & LOCK_MODE_WAIT);
+  }
+  
+  /* Read and print the value */
+  if (status) {
+    status = sourceRead(&src, addr, buf, pt->width);
+  }
+  if (status) {
+    printValue(pt, binpoke_decode(buf, pt));
+    printf("\n");
+  }
+  
+  /* Release session, readers, and locks, and close viewer if open */
+  sessionFree(&es);
+#ifdef BINPOKE_GZIP
+  gzClose(&gz);
+#endif
+  binpoke_close(pb);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to write an integer value into a file.
+ * 
+ * Parameters:
+ * 
+ *   pPath - path to the file
+ * 
+ *   pAt - string parameter with the address of the integer
+ * 
+ *   pAs - string parameter with the integer type
+ * 
+ *   pWith - string parameter with the integer value
+ * 
+ *   pIn - string parameter with the editing mode, or NULL for the
+ *   default mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_write(
+    const char *pPath,
+    const char *pAt,
+    const char *pAs,
+    const char *pWith,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  BINPOKE *pb = NULL;
+  
+  int64_t addr = 0;
+  int64_t flen = 0;
+  int mode = 0;
+  const BINPOKE_TYPE *pt = NULL;
+  uint64_t v = 0;
+  uint8_t buf[8];
+  
+  EDIT_SESSION es;
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  memset(&es, 0, sizeof(EDIT_SESSION));
+  lk.fd = -1;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pAt == NULL) || (pAs == NULL) ||
+      (pWith == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the address */
+  addr = binpoke_parseaddress(pAt);
+  if (addr < 0) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to parse address: %s\n",
+              pModule, pAt);
+  }
+  
+  /* Get the type */
+  if (status) {
+    pt = binpoke_parsetype(pAs);
+    if (pt == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Unrecognized type: %s\n", pModule, pAs);
+    }
+  }
+  
+  /* Get the value */
+  if (status) {
+    if (!binpoke_parsevalue(pWith, pt, &v)) {
+      status = 0;
+      fprintf(stderr, "%s: Invalid value for type %s: %s\n",
+                pModule, pAs, pWith);
+    }
+  }
+  
+  /* Get the mode, if provided */
+  if (status && (pIn != NULL)) {
+    mode = parseMode(pIn, editModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse editing mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Load the edit session or open a read-write view, and get the file
+   * length */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    status = sessionLoad(&es, pPath, AKSVIEW_READONLY);
+    if (status) {
+      flen = es.len;
+    }
+    
+  } else if (status) {
+    pb = binpoke_open(pPath, BINPOKE_READWRITE, &errcode);
+    if (pb == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, binpoke_errstr(errcode));
+    } else {
+      flen = binpoke_getlen(pb);
+    }
+  }
+  
+  /* Check that all bytes of the integer are within file limits */
+  if (status) {
+    if (addr > flen - pt->width) {
+      status = 0;
+      fprintf(stderr, "%s: Given address is outside file limits!\n",
+                pModule);
+    }
+  }
+  
+  /* Lock the bytes of the integer for writing */
+  if (status && (pb != NULL)) {
+    status = lockRange(&lk, pPath, addr, pt->width, 1,
+                        mode & LOCK_MODE_WAIT);
+  }
+  
+  /* Write the value, replacing the bytes within an edit session */
+  if (status) {
+    if (mode & EDIT_MODE_SESSION) {
+      binpoke_encode(buf, pt, v);
+      if ((!sessionRemove(&es, addr, pt->width)) ||
+          (!sessionInsert(&es, addr, buf, pt->width))) {
+        status = 0;
+        fprintf(stderr, "%s: Edit session is full!\n", pModule);
+      }
+    } else {
+      if (!binpoke_write(pb, addr, pt, v, &errcode)) {
+        status = 0;
+        fprintf(stderr, "%s: %s!\n", pModule, binpoke_errstr(errcode));
+      }
+    }
+  }
+  
+  /* Save the edit session */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    status = sessionSave(&es, pPath);
+  }
+  
+  /* Release session and locks, and close viewer if open */
+  sessionFree(&es);
+  binpoke_close(pb);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to report the file size of an existing file.
+ * 
+ * If more than one path is given, binpoke_query() finds the size of
+ * every file, and printQuery() reports each on its own line.
+ * 
+ * In list mode, the path is instead a path list, and queryList() is
+ * used to report the size of every file in the list.
+ * 
+ * In gzip mode, the path is a gzip file, and its uncompressed length is
+ * reported.  This builds the seek-point index of the file if necessary.
+ * 
+ * Parameters:
+ * 
+ *   ppPath - the array of paths to the files
+ * 
+ *   pathc - the number of paths, which must be at least one
+ * 
+ *   pIn - string parameter with the query mode, or NULL for the default
+ *   mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_query(char **ppPath, int pathc, const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  int mode = 0;
+  int i = 0;
+  const char *pPath = NULL;
+  BINPOKE *pb = NULL;
+  int64_t *pLens = NULL;
+  int *pErrs = NULL;
+  
+#ifdef BINPOKE_GZIP
+  GZ_READER gz;
+  
+  /* Initialize structures */
+  memset(&gz, 0, sizeof(GZ_READER));
+#endif
+  
+  /* Check parameters */
+  if ((ppPath == NULL) || (pathc < 1)) {
+    fault(__LINE__);
+  }
+  for(i = 0; i < pathc; i++) {
+    if (ppPath[i] == NULL) {
+      fault(__LINE__);
+    }
+  }
+  pPath = ppPath[0];
+  
+  /* Get the mode, if provided */
+  if (pIn != NULL) {
+    mode = parseMode(pIn, queryModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse query mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* List mode only reports compressed lengths */
+  if (status && (mode & QUERY_MODE_LIST) && (mode & QUERY_MODE_GZIP)) {
+    status = 0;
+    fprintf(stderr, "%s: Can't query a list of gzip files!\n", pModule);
+  }
+  
+  /* More than one path may only be given in the default mode */
+  if (status && (pathc > 1) && (mode != 0)) {
+    status = 0;
+    fprintf(stderr, "%s: Can't give more than one path in this mode!\n",
+              pModule);
+  }
+  
+  /* Query every file if more than one path is given, carrying on past
+   * any that fail, and then print a line for each */
+  if (status && (pathc > 1)) {
+    pLens = (int64_t *) bufAlloc(((int64_t) pathc) *
+                                  ((int64_t) sizeof(int64_t)));
+    if (pLens != NULL) {
+      pErrs = (int *) bufAlloc(((int64_t) pathc) *
+                                ((int64_t) sizeof(int)));
+    }
+    if (pErrs == NULL) {
+      status = 0;
+    }
+    
+    if (status) {
+      status = binpoke_query((const char *const *) ppPath,
+                              (int64_t) pathc, pLens, pErrs);
+      for(i = 0; i < pathc; i++) {
+        printQuery(ppPath[i], pLens[i], pErrs[i]);
+      }
+    }
+    
+    bufFree(pErrs);
+    bufFree(pLens);
+  }
+  
+  /* Hand list mode over to queryList() */
+  if (status && (mode & QUERY_MODE_LIST)) {
+    status = queryList(pPath);
+  }
+  
+  /* Open the gzip reader and print the uncompressed length in gzip
+   * mode */
+  if (status && (mode & QUERY_MODE_GZIP)) {
+#ifdef BINPOKE_GZIP
+    status = gzOpen(&gz, pPath);
+    if (status) {
+      printf("Uncompressed length: ");
+      printInt64(gz.len);
+      printf("\n");
+    }
+    gzClose(&gz);
+#else
+    fault(__LINE__);
+#endif
+  }
+  
+  /* Otherwise, open a read-only view of the one file */
+  if (status && (pathc < 2) &&
+      (!(mode & (QUERY_MODE_LIST | QUERY_MODE_GZIP)))) {
+    pb = binpoke_open(pPath, BINPOKE_READONLY, &errcode);
+    if (pb == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, binpoke_errstr(errcode));
+    }
+  }
+  
+  /* Print the file length */
+  if (status && (pb != NULL)) {
+    printf("File length: ");
+    printInt64(binpoke_getlen(pb));
+    printf("\n");
+  }
+  
+  /* Close viewer if open */
+  binpoke_close(pb);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to resize an existing file.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pWith - string parameter containing the new length
+ * 
+ *   pIn - string parameter with the editing mode, or NULL for the
+ *   default mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_resize(
+    const char *pPath,
+    const char *pWith,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  int64_t fl = 0;
+  int64_t flen = 0;
+  int mode = 0;
+  BINPOKE *pb = NULL;
+  
+  EDIT_SESSION es;
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  memset(&es, 0, sizeof(EDIT_SESSION));
+  lk.fd = -1;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pWith == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Parse the desired new file length */
+  fl = binpoke_parsecount(pWith);
+  if (fl < 0) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to parse count: %s\n",
+              pModule, pWith);
+  }
+  
+  /* Make sure file length doesn't exceed aksview limit */
+  if (status && (fl > AKSVIEW_MAXLEN)) {
+    status = 0;
+    fprintf(stderr, "%s: Length exceeded AKSVIEW_MAXLEN!\n", pModule);
+  }
+  
+  /* Get the mode, if provided */
+  if (status && (pIn != NULL)) {
+    mode = parseMode(pIn, editModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse editing mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Load the edit session or open a read-write view, and get the file
+   * length */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    status = sessionLoad(&es, pPath, AKSVIEW_READONLY);
+    if (status) {
+      flen = es.len;
+    }
+    
+  } else if (status) {
+    pb = binpoke_open(pPath, BINPOKE_READWRITE, &errcode);
+    if (pb == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, binpoke_errstr(errcode));
+    } else {
+      flen = binpoke_getlen(pb);
+    }
+  }
+  
+  /* Lock everything from the shorter of the two lengths onwards for
+   * writing */
+  if (status && (pb != NULL)) {
+    if (fl < flen) {
+      status = lockRange(&lk, pPath, fl, LOCK_TO_END, 1,
+                          mode & LOCK_MODE_WAIT);
+    } else {
+      status = lockRange(&lk, pPath, flen, LOCK_TO_END, 1,
+                          mode & LOCK_MODE_WAIT);
+    }
+  }
+  
+  /* Set the file length, or within an edit session remove bytes from
+   * the end or append zero bytes */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    if (fl < flen) {
+      if (!sessionRemove(&es, fl, flen - fl)) {
+        status = 0;
+        fprintf(stderr, "%s: Edit session is full!\n", pModule);
+      }
+    } else {
+      if (!sessionInsert(&es, flen, NULL, fl - flen)) {
+        status = 0;
+        fprintf(stderr, "%s: Edit session is full!\n", pModule);
+      }
+    }
+    
+  } else if (status) {
+    if (!binpoke_setlen(pb, fl, &errcode)) {
+      status = 0;
+      fprintf(stderr, "%s: %s!\n", pModule, binpoke_errstr(errcode));
+    }
+  }
+  
+  /* Save the edit session */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    status = sessionSave(&es, pPath);
+  }
+  
+  /* Release session and locks, and close viewer if open */
+  sessionFree(&es);
+  binpoke_close(pb);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to apply a batch of integer writes to an existing file.
+ * 
+ * The batch script is a text file containing a sequence of writes,
+ * each of which is an address, a type, and a value, in the same formats
+ * as for the write verb.  All writes are parsed and checked against the
+ * file limits before any data is modified.
+ * 
+ * In journal mode, the original bytes of every range that will be
+ * written are first recorded in the undo journal, which is closed and
+ * flushed to disk before the data file is touched.  The header of the
+ * journal holds a checksum of the records, since the flush does not
+ * order the header after them.  After all writes
+ * have been applied, the data file is closed and flushed to disk, and
+ * then the journal is emptied and flushed again to commit the batch.
+ * This costs three flushes per batch rather than per write.
+ * 
+ * In either mode, the batch is refused if the undo journal still holds
+ * an interrupted batch.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pWith - the path to the batch script
+ * 
+ *   pIn - string parameter with the batch mode, or NULL for the default
+ *   mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_batch(
+    const char *pPath,
+    const char *pWith,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  int mode = 0;
+  int created = 0;
+  int r = 0;
+  
+  BINPOKE *pb = NULL;
+  BINPOKE *ps = NULL;
+  BINPOKE *pj = NULL;
+  char *pJPath = NULL;
+  
+  int64_t spos = 0;
+  int64_t x = 0;
+  uint64_t sum = 0;
+  
+  BINPOKE_OP *pOps = NULL;
+  int64_t op_count = 0;
+  int64_t op_cap = 0;
+  BINPOKE_OP *pNew = NULL;
+  
+  char tAddr[BATCH_MAXTOKEN + 1];
+  char tType[BATCH_MAXTOKEN + 1];
+  char tVal[BATCH_MAXTOKEN + 1];
+  uint8_t rec[JOURNAL_RECORD];
+  
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  lk.fd = -1;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pWith == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the mode, if provided */
+  if (pIn != NULL) {
+    mode = parseMode(pIn, batchModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse batch mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Open the batch script */
+  if (status) {
+    ps = binpoke_open(pWith, BINPOKE_READONLY, &errcode);
+    if (ps == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open batch script: %s\n",
+                pModule, binpoke_errstr(errcode));
+    }
+  }
+  
+  /* Parse all the operations in the script */
+  while (status) {
+    /* Read the address token, leaving loop if no more operations */
+    r = readToken(ps, &spos, tAddr, BATCH_MAXTOKEN + 1);
+    if (r == 0) {
+      break;
+    }
+    
+    /* Read the type and value tokens */
+    if (r > 0) {
+      r = readToken(ps, &spos, tType, BATCH_MAXTOKEN + 1);
+    }
+    if (r > 0) {
+      r = readToken(ps, &spos, tVal, BATCH_MAXTOKEN + 1);
+    }
+    if (r <= 0) {
+      status = 0;
+      fprintf(stderr, "%s: Batch operation ", pModule);
+      fprintInt64(stderr, op_count + 1);
+      fprintf(stderr, " is incomplete!\n");
+    }
+    
+    /* Take or grow the operation array within the buffer pool */
+    if (status && (op_count >= op_cap)) {
+      if (op_cap < 1) {
+        op_cap = 64;
+      } else {
+        op_cap *= 2;
+      }
+      pNew = (BINPOKE_OP *) bufGrow(
+                pOps, op_cap * ((int64_t) sizeof(BINPOKE_OP)));
+      if (pNew != NULL) {
+        pOps = pNew;
+      } else {
+        status = 0;
+      }
+    }
+    
+    /* Parse the operation */
+    if (status) {
+      pOps[op_count].addr = binpoke_parseaddress(tAddr);
+      if (pOps[op_count].addr < 0) {
+        status = 0;
+        fprintf(stderr, "%s: Failed to parse address: %s\n",
+                  pModule, tAddr);
+      }
+    }
+    
+    if (status) {
+      pOps[op_count].pt = binpoke_parsetype(tType);
+      if (pOps[op_count].pt == NULL) {
+        status = 0;
+        fprintf(stderr, "%s: Unrecognized type: %s\n", pModule, tType);
+      }
+    }
+    
+    if (status) {
+      if (!binpoke_parsevalue(tVal, pOps[op_count].pt,
+            &(pOps[op_count].val))) {
+        status = 0;
+        fprintf(stderr, "%s: Invalid value for type %s: %s\n",
+                  pModule, tType, tVal);
+      }
+    }
+    
+    if (status) {
+      op_count++;
+    }
+  }
+  
+  /* Close the batch script */
+  binpoke_close(ps);
+  ps = NULL;
+  
+  /* Open a read-write view of the data file */
+  if (status) {
+    pb = binpoke_open(pPath, BINPOKE_READWRITE, &errcode);
+    if (pb == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, binpoke_errstr(errcode));
+    }
+  }
+  
+  /* Check that every operation is within the file limits */
+  if (status) {
+    for(x = 0; x < op_count; x++) {
+      if (pOps[x].addr > binpoke_getlen(pb) - pOps[x].pt->width) {
+        status = 0;
+        fprintf(stderr, "%s: Batch operation ", pModule);
+        fprintInt64(stderr, x + 1);
+        fprintf(stderr, " is outside file limits!\n");
+        break;
+      }
+    }
+  }
+  
+  /* Lock the range of every operation for writing */
+  if (status) {
+    for(x = 0; x < op_count; x++) {
+      status = lockRange(&lk, pPath, pOps[x].addr, pOps[x].pt->width, 1,
+                          mode & LOCK_MODE_WAIT);
+      if (!status) {
+        break;
+      }
+    }
+  }
+  
+  /* Make sure there is no interrupted batch recorded in the undo
+   * journal, whatever the mode, since writing over its bytes would make
+   * it impossible to roll back */
+  if (status) {
+    pJPath = sidecarPath(pPath, JOURNAL_SUFFIX);
+    if (fileExists(pJPath)) {
+      pj = binpoke_open(pJPath, BINPOKE_READONLY, &errcode);
+      if (pj == NULL) {
+        status = 0;
+        fprintf(stderr, "%s: Failed to open undo journal: %s\n",
+                  pModule, binpoke_errstr(errcode));
+      }
+      
+      if (status && (binpoke_getlen(pj) > 0)) {
+        status = 0;
+        fprintf(stderr, "%s: Undo journal holds an interrupted batch; "
+                  "use the recover verb first!\n", pModule);
+      }
+      
+      binpoke_close(pj);
+      pj = NULL;
+      
+    } else {
+      created = 1;
+    }
+  }
+  
+  /* In journal mode, open the undo journal */
+  if (status && (mode & BATCH_MODE_JOURNAL)) {
+    pj = binpoke_open(pJPath, BINPOKE_CREATE, &errcode);
+    if (pj == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open undo journal: %s\n",
+                pModule, binpoke_errstr(errcode));
+    }
+  }
+  
+  /* Record the before-image of every write in the journal, then close
+   * the journal and flush it to disk, along with its directory entry if
+   * the journal is new, so it is complete before any data is
+   * modified */
+  if (status && (pj != NULL)) {
+    if (!binpoke_setlen(pj, JOURNAL_HEADER + (op_count * JOURNAL_RECORD),
+          NULL)) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to set length on undo journal!\n",
+                pModule);
+    }
+    
+    if (status) {
+      for(x = 0; x < op_count; x++) {
+        memset(rec, 0, JOURNAL_RECORD);
+        binpoke_encode(rec, pSidecarType, (uint64_t) pOps[x].addr);
+        rec[8] = (uint8_t) pOps[x].pt->width;
+        binpoke_readbytes(pb, pOps[x].addr, rec + 9, pOps[x].pt->width,
+                            NULL);
+        binpoke_writebytes(pj, JOURNAL_HEADER + (x * JOURNAL_RECORD),
+                            rec, JOURNAL_RECORD, NULL);
+        sum = journalSum(sum, rec);
+      }
+      
+      binpoke_writebytes(pj, 0, (const uint8_t *) JOURNAL_SIGNATURE, 8,
+                          NULL);
+      binpoke_write(pj, 8, pSidecarType, (uint64_t) op_count, NULL);
+      binpoke_write(pj, 16, pSidecarType, sum, NULL);
+    }
+    
+    binpoke_close(pj);
+    pj = NULL;
+    
+    if (status) {
+      status = syncFile(pJPath);
+    }
+    if (status && created) {
+      status = syncParent(pJPath);
+    }
+  }
+  
+  /* Apply all the writes and close the data file */
+  if (status) {
+    if (!binpoke_writebatch(pb, pOps, op_count, &x, &errcode)) {
+      status = 0;
+      fprintf(stderr, "%s: Batch operation ", pModule);
+      fprintInt64(stderr, x + 1);
+      fprintf(stderr, ": %s!\n", binpoke_errstr(errcode));
+    }
+  }
+  binpoke_close(pb);
+  pb = NULL;
+  
+  /* In journal mode, flush the data to disk, and then commit the batch
+   * by emptying the journal and flushing it to disk too */
+  if (status && (mode & BATCH_MODE_JOURNAL)) {
+    status = syncFile(pPath);
+  }
+  
+  if (status && (mode & BATCH_MODE_JOURNAL)) {
+    pj = binpoke_open(pJPath, BINPOKE_READWRITE, &errcode);
+    if (pj == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open undo journal: %s\n",
+                pModule, binpoke_errstr(errcode));
+    }
+    
+    if (status) {
+      if (!binpoke_setlen(pj, 0, NULL)) {
+        status = 0;
+        fprintf(stderr, "%s: Failed to commit undo journal!\n",
+                  pModule);
+      }
+    }
+    
+    binpoke_close(pj);
+    pj = NULL;
+    
+    if (status) {
+      status = syncFile(pJPath);
+    }
+  }
+  
+  /* Release buffers and locks */
+  bufFree(pOps);
+  free(pJPath);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to roll back an interrupted journaled batch.
+ * 
+ * If the undo journal does not exist or is empty, there is nothing to
+ * roll back.  If the journal is incomplete, because its header is
+ * missing or does not match its records, or a record is not within the
+ * file limits, the batch was interrupted before any data was modified,
+ * so the journal is simply discarded.
+ * Otherwise, the before-images are restored in reverse order, so that
+ * the original bytes win where writes overlapped, and the data file is
+ * flushed to disk.  The journal is then emptied and flushed to disk.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_recover(const char *pPath) {
+  
+  int status = 1;
+  int errcode = 0;
+  int valid = 1;
+  int w = 0;
+  
+  BINPOKE *pb = NULL;
+  BINPOKE *pj = NULL;
+  char *pJPath = NULL;
+  
+  int64_t jlen = 0;
+  int64_t rec_count = 0;
+  int64_t jpos = 0;
+  int64_t x = 0;
+  uint64_t uv = 0;
+  uint64_t sum = 0;
+  uint8_t hdr[JOURNAL_HEADER];
+  uint8_t rec[JOURNAL_RECORD];
+  
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  lk.fd = -1;
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Open the undo journal, if there is one */
+  pJPath = sidecarPath(pPath, JOURNAL_SUFFIX);
+  if (fileExists(pJPath)) {
+    pj = binpoke_open(pJPath, BINPOKE_READWRITE, &errcode);
+    if (pj == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open undo journal: %s\n",
+                pModule, binpoke_errstr(errcode));
+    }
+  } else {
+    valid = 0;
+    printf("No interrupted batch to recover.\n");
+  }
+  
+  /* Check whether there is anything to roll back */
+  if (status && valid) {
+    jlen = binpoke_getlen(pj);
+    if (jlen < 1) {
+      valid = 0;
+      printf("No interrupted batch to recover.\n");
+    }
+  }
+  
+  /* Check that the journal is complete */
+  if (status && valid) {
+    if (jlen < JOURNAL_HEADER) {
+      valid = 0;
+    }
+    
+    if (valid) {
+      binpoke_readbytes(pj, 0, hdr, JOURNAL_HEADER, NULL);
+      if (memcmp(hdr, JOURNAL_SIGNATURE, 8) != 0) {
+        valid = 0;
+      }
+    }
+    
+    if (valid) {
+      uv = binpoke_decode(hdr + 8, pSidecarType);
+      if (uv != (uint64_t) ((jlen - JOURNAL_HEADER) / JOURNAL_RECORD)) {
+        valid = 0;
+      } else if ((jlen - JOURNAL_HEADER) % JOURNAL_RECORD != 0) {
+        valid = 0;
+      } else {
+        rec_count = (int64_t) uv;
+      }
+    }
+    
+    /* Check the records against the checksum in the header */
+    if (valid) {
+      uv = binpoke_decode(hdr + 16, pSidecarType);
+      for(x = 0; x < rec_count; x++) {
+        jpos = JOURNAL_HEADER + (x * JOURNAL_RECORD);
+        binpoke_readbytes(pj, jpos, rec, JOURNAL_RECORD, NULL);
+        sum = journalSum(sum, rec);
+      }
+      if (sum != uv) {
+        valid = 0;
+      }
+    }
+  }
+  
+  /* If the journal is complete, open the data file and check that every
+   * record is within the file limits */
+  if (status && valid) {
+    pb = binpoke_open(pPath, BINPOKE_READWRITE, &errcode);
+    if (pb == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, binpoke_errstr(errcode));
+    }
+    
+    for(x = 0; status && valid && (x < rec_count); x++) {
+      jpos = JOURNAL_HEADER + (x * JOURNAL_RECORD);
+      binpoke_readbytes(pj, jpos, rec, JOURNAL_RECORD, NULL);
+      uv = binpoke_decode(rec, pSidecarType);
+      w = (int) rec[8];
+      if ((uv > (uint64_t) INT64_MAX) || (w < 1) || (w > 8) ||
+          ((int64_t) uv > binpoke_getlen(pb) - w)) {
+        valid = 0;
+      }
+    }
+  }
+  
+  /* An incomplete journal was never relied on, so it is discarded */
+  if (status && (jlen > 0) && (!valid)) {
+    printf("Discarding incomplete undo journal.\n");
+  }
+  
+  /* Lock the range of every record for writing */
+  if (status && valid) {
+    for(x = 0; status && (x < rec_count); x++) {
+      jpos = JOURNAL_HEADER + (x * JOURNAL_RECORD);
+      binpoke_readbytes(pj, jpos, rec, JOURNAL_RECORD, NULL);
+      status = lockRange(&lk, pPath,
+                          (int64_t) binpoke_decode(rec, pSidecarType),
+                          (int64_t) rec[8], 1, 0);
+    }
+  }
+  
+  /* Restore the before-images in reverse order */
+  if (status && valid) {
+    for(x = rec_count - 1; x >= 0; x--) {
+      jpos = JOURNAL_HEADER + (x * JOURNAL_RECORD);
+      binpoke_readbytes(pj, jpos, rec, JOURNAL_RECORD, NULL);
+      binpoke_writebytes(pb, (int64_t) binpoke_decode(rec, pSidecarType),
+                          rec + 9, (int32_t) rec[8], NULL);
+    }
+    printf("Rolled back ");
+    printInt64(rec_count);
+    printf(" write(s).\n");
+  }
+  
+  /* Close the data file and flush the restored data to disk before the
+   * journal is emptied */
+  binpoke_close(pb);
+  pb = NULL;
+  
+  if (status && valid) {
+    status = syncFile(pPath);
+  }
+  
+  /* Empty the journal, close it, and flush it to disk */
+  if (status && (jlen > 0)) {
+    if (!binpoke_setlen(pj, 0, NULL)) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to empty undo journal!\n", pModule);
+    }
+  }
+  
+  binpoke_close(pj);
+  pj = NULL;
+  
+  if (status && (jlen > 0)) {
+    status = syncFile(pJPath);
+  }
+  
+  /* Release path and locks */
+  free(pJPath);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to reverse the byte order of every element in a range of a
+ * file.
+ * 
+ * The range is streamed through a buffer of BLOCK_SIZE bytes, which is
+ * always a whole number of elements.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pFrom - string parameter with starting address
+ * 
+ *   pFor - string parameter with byte count
+ * 
+ *   pAs - string parameter with the element bit width
+ * 
+ *   pIn - string parameter with the scan mode, or NULL for the default
+ *   mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_swap(
+    const char *pPath,
+    const char *pFrom,
+    const char *pFor,
+    const char *pAs,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  int mode = 0;
+  AKSVIEW *pv = NULL;
+  
+  int64_t addr = 0;
+  int64_t count = 0;
+  int width = 0;
+  
+  int64_t p = 0;
+  int32_t blen = 0;
+  uint8_t *pBuf = NULL;
+  
+  CACHE_DROP cd;
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  memset(&cd, 0, sizeof(CACHE_DROP));
+  cd.fd = -1;
+  lk.fd = -1;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pFrom == NULL) || (pFor == NULL) ||
+      (pAs == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the address */
+  addr = binpoke_parseaddress(pFrom);
+  if (addr < 0) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to parse address: %s\n",
+              pModule, pFrom);
+  }
+  
+  /* Get the count */
+  if (status) {
+    count = binpoke_parsecount(pFor);
+    if (count < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse count: %s\n",
+                pModule, pFor);
+    }
+  }
+  
+  /* Get the element width in bytes */
+  if (status) {
+    if (strcmp(pAs, "16") == 0) {
+      width = 2;
+    } else if (strcmp(pAs, "32") == 0) {
+      width = 4;
+    } else if (strcmp(pAs, "64") == 0) {
+      width = 8;
+    } else {
+      status = 0;
+      fprintf(stderr, "%s: Unrecognized element width: %s\n",
+                pModule, pAs);
+    }
+  }
+  
+  /* Get the mode, if provided */
+  if (status && (pIn != NULL)) {
+    mode = parseMode(pIn, scanModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse scan mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Check that count is a whole number of elements */
+  if (status && (count % width != 0)) {
+    status = 0;
+    fprintf(stderr, "%s: Count is not a multiple of element width!\n",
+              pModule);
+  }
+  
+  /* Open a read-write view */
+  if (status) {
+    pv = aksview_create(pPath, AKSVIEW_EXISTING, &errcode);
+    if (pv == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
+  }
+  
+  /* Check that the range is within file limits */
+  if (status) {
+    if ((addr > aksview_getlen(pv)) ||
+        (count > aksview_getlen(pv) - addr)) {
+      status = 0;
+      fprintf(stderr, "%s: Given byte range goes beyond end of file!\n",
+                pModule);
+    }
+  }
+  
+  /* Lock the range for writing */
+  if (status) {
+    status = lockRange(&lk, pPath, addr, count, 1,
+                        mode & LOCK_MODE_WAIT);
+  }
+  
+  /* Take the block buffer */
+  if (status) {
+    pBuf = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    if (pBuf == NULL) {
+      status = 0;
+    }
+  }
+  
+  /* Swap each block in place */
+  if (status) {
+    cacheOpen(&cd, pPath, mode & SCAN_MODE_NOCACHE);
+    for(p = addr; p < addr + count; p += blen) {
+      /* Get the length of this block; BLOCK_SIZE is a multiple of every
+       * element width, and so is the count */
+      if (addr + count - p < BLOCK_SIZE) {
+        blen = (int32_t) (addr + count - p);
+      } else {
+        blen = BLOCK_SIZE;
+      }
+      
+      /* Read the block, reverse each element, and write it back */
+      readBlock(pv, p, pBuf, blen);
+      swapBlock(pBuf, blen, width);
+      writeBlock(pv, p, pBuf, blen);
+      cacheDrop(&cd, p, blen);
+    }
+  }
+  
+  /* Release buffer and locks, and close viewer and cache dropper if
+   * open */
+  bufFree(pBuf);
+  aksview_close(pv);
+  cacheClose(&cd);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to insert a range of zero-valued bytes into a file.
+ * 
+ * The file is first extended, then all bytes from the insertion point
+ * to the old end of the file are moved up, and finally the inserted
+ * range is cleared to zero.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pAt - string parameter with the insertion address
+ * 
+ *   pFor - string parameter with the number of bytes to insert
+ * 
+ *   pIn - string parameter with the editing mode, or NULL for the
+ *   default mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_insert(
+    const char *pPath,
+    const char *pAt,
+    const char *pFor,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  AKSVIEW *pv = NULL;
+  
+  int64_t addr = 0;
+  int64_t count = 0;
+  int64_t flen = 0;
+  int mode = 0;
+  int64_t p = 0;
+  int64_t clear_end = 0;
+  int32_t blen = 0;
+  uint8_t *pBuf = NULL;
+  
+  EDIT_SESSION es;
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  memset(&es, 0, sizeof(EDIT_SESSION));
+  lk.fd = -1;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pAt == NULL) || (pFor == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the address */
+  addr = binpoke_parseaddress(pAt);
+  if (addr < 0) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to parse address: %s\n",
+              pModule, pAt);
+  }
+  
+  /* Get the count */
+  if (status) {
+    count = binpoke_parsecount(pFor);
+    if (count < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse count: %s\n",
+                pModule, pFor);
+    }
+  }
+  
+  /* Get the mode, if provided */
+  if (status && (pIn != NULL)) {
+    mode = parseMode(pIn, editModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse editing mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Load the edit session or open a read-write view, and get the file
+   * length */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    status = sessionLoad(&es, pPath, AKSVIEW_READONLY);
+    if (status) {
+      flen = es.len;
+    }
+    
+  } else if (status) {
+    pv = aksview_create(pPath, AKSVIEW_EXISTING, &errcode);
+    if (pv == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, aksview_errstr(errcode));
+    } else {
+      flen = aksview_getlen(pv);
+    }
+  }
+  
+  /* Check that the address is at most the end of the file, and that the
+   * new length does not exceed the aksview limit */
+  if (status) {
+    if (addr > flen) {
+      status = 0;
+      fprintf(stderr, "%s: Given address is outside file limits!\n",
+                pModule);
+    }
+  }
+  
+  if (status && (count > AKSVIEW_MAXLEN - flen)) {
+    status = 0;
+    fprintf(stderr, "%s: Length exceeded AKSVIEW_MAXLEN!\n", pModule);
+  }
+  
+  /* Within an edit session, just record the insertion */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    if (!sessionInsert(&es, addr, NULL, count)) {
+      status = 0;
+      fprintf(stderr, "%s: Edit session is full!\n", pModule);
+    }
+  }
+  
+  /* Save the edit session */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    status = sessionSave(&es, pPath);
+  }
+  
+  /* Otherwise, take the block buffer before anything is changed, lock
+   * everything from the address onwards for writing, and extend the
+   * file */
+  if (status && (count > 0) && (pv != NULL)) {
+    pBuf = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    if (pBuf == NULL) {
+      status = 0;
+    }
+  }
+  
+  if (status && (count > 0) && (pv != NULL)) {
+    status = lockRange(&lk, pPath, addr, LOCK_TO_END, 1,
+                        mode & LOCK_MODE_WAIT);
+  }
+  
+#ifdef BINPOKE_FALLOCATE
+  /* Try to have the filesystem shift the tail up, which leaves the
+   * inserted range as zero bytes; the view is closed first so that it
+   * does not keep the old length, and opened again if this fails */
+  if (status && (count > 0) && (pv != NULL)) {
+    aksview_close(pv);
+    pv = NULL;
+    if (!shiftRange(pPath, addr, count, 1)) {
+      pv = aksview_create(pPath, AKSVIEW_EXISTING, &errcode);
+      if (pv == NULL) {
+        status = 0;
+        fprintf(stderr, "%s: Failed to open file: %s\n",
+                  pModule, aksview_errstr(errcode));
+      }
+    }
+  }
+#endif
+  
+  if (status && (count > 0) && (pv != NULL)) {
+    if (!aksview_setlen(pv, flen + count)) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to set length on file!\n", pModule);
+    }
+  }
+  
+  /* Move the tail up and clear the part of the inserted range that held
+   * old data; anything beyond the old end is already zero from the
+   * extension */
+  if (status && (count > 0) && (pv != NULL)) {
+    moveRange(pv, addr, addr + count, flen - addr, pBuf);
+    
+    memset(pBuf, 0, BLOCK_SIZE);
+    if (addr + count < flen) {
+      clear_end = addr + count;
+    } else {
+      clear_end = flen;
+    }
+    for(p = addr; p < clear_end; p += blen) {
+      if (clear_end - p < BLOCK_SIZE) {
+        blen = (int32_t) (clear_end - p);
+      } else {
+        blen = BLOCK_SIZE;
+      }
+      writeBlock(pv, p, pBuf, blen);
+    }
+  }
+  
+  /* Release buffer, session, and locks, and close viewer if open */
+  bufFree(pBuf);
+  sessionFree(&es);
+  aksview_close(pv);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to remove a range of bytes from a file.
+ * 
+ * All bytes after the removed range are moved down over it, and then
+ * the file is shortened.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pFrom - string parameter with the address of the first byte to
+ *   remove
+ * 
+ *   pFor - string parameter with the number of bytes to remove
+ * 
+ *   pIn - string parameter with the editing mode, or NULL for the
+ *   default mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_remove(
+    const char *pPath,
+    const char *pFrom,
+    const char *pFor,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  AKSVIEW *pv = NULL;
+  
+  int64_t addr = 0;
+  int64_t count = 0;
+  int64_t flen = 0;
+  int mode = 0;
+  uint8_t *pBuf = NULL;
+  
+  EDIT_SESSION es;
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  memset(&es, 0, sizeof(EDIT_SESSION));
+  lk.fd = -1;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pFrom == NULL) || (pFor == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the address */
+  addr = binpoke_parseaddress(pFrom);
+  if (addr < 0) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to parse address: %s\n",
+              pModule, pFrom);
+  }
+  
+  /* Get the count */
+  if (status) {
+    count = binpoke_parsecount(pFor);
+    if (count < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse count: %s\n",
+                pModule, pFor);
+    }
+  }
+  
+  /* Get the mode, if provided */
+  if (status && (pIn != NULL)) {
+    mode = parseMode(pIn, editModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse editing mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Load the edit session or open a read-write view, and get the file
+   * length */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    status = sessionLoad(&es, pPath, AKSVIEW_READONLY);
+    if (status) {
+      flen = es.len;
+    }
+    
+  } else if (status) {
+    pv = aksview_create(pPath, AKSVIEW_EXISTING, &errcode);
+    if (pv == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, aksview_errstr(errcode));
+    } else {
+      flen = aksview_getlen(pv);
+    }
+  }
+  
+  /* Check that the range is within file limits */
+  if (status) {
+    if ((addr > flen) || (count > flen - addr)) {
+      status = 0;
+      fprintf(stderr, "%s: Given byte range goes beyond end of file!\n",
+                pModule);
+    }
+  }
+  
+  /* Within an edit session, just record the removal */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    if (!sessionRemove(&es, addr, count)) {
+      status = 0;
+      fprintf(stderr, "%s: Edit session is full!\n", pModule);
+    }
+  }
+  
+  /* Save the edit session */
+  if (status && (mode & EDIT_MODE_SESSION)) {
+    status = sessionSave(&es, pPath);
+  }
+  
+  /* Otherwise, lock everything from the address onwards for writing,
+   * and move the tail down over the removed range */
+  if (status && (count > 0) && (pv != NULL)) {
+    status = lockRange(&lk, pPath, addr, LOCK_TO_END, 1,
+                        mode & LOCK_MODE_WAIT);
+  }
+  
+#ifdef BINPOKE_FALLOCATE
+  /* Try to have the filesystem cut out the range and shift the tail
+   * down; the view is closed first so that it does not keep the old
+   * length, and opened again if this fails */
+  if (status && (count > 0) && (pv != NULL)) {
+    aksview_close(pv);
+    pv = NULL;
+    if (!shiftRange(pPath, addr, count, 0)) {
+      pv = aksview_create(pPath, AKSVIEW_EXISTING, &errcode);
+      if (pv == NULL) {
+        status = 0;
+        fprintf(stderr, "%s: Failed to open file: %s\n",
+                  pModule, aksview_errstr(errcode));
+      }
+    }
+  }
+#endif
+  
+  if (status && (count > 0) && (pv != NULL)) {
+    pBuf = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    if (pBuf != NULL) {
+      moveRange(pv, addr + count, addr, flen - addr - count, pBuf);
+    } else {
+      status = 0;
+    }
+  }
+  
+  /* Shorten the file */
+  if (status && (count > 0) && (pv != NULL)) {
+    if (!aksview_setlen(pv, flen - count)) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to set length on file!\n", pModule);
+    }
+  }
+  
+  /* Release buffer, session, and locks, and close viewer if open */
+  bufFree(pBuf);
+  sessionFree(&es);
+  aksview_close(pv);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to import a hex dump listing back into a file.
+ * 
+ * The listing may contain listing lines in the format of the list verb,
+ * collapse markers, and plain hex data, as described for importLine().
+ * The whole listing is parsed and checked against the file limits
+ * before any data in the file is modified, so a listing with an error
+ * leaves the file untouched.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pWith - string parameter with the path to the listing
+ * 
+ *   pAt - string parameter with the address where plain hex data at the
+ *   start of the listing goes, or NULL for address zero
+ * 
+ *   pIn - string parameter with the scan mode, or NULL for the default
+ *   mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_import(
+    const char *pPath,
+    const char *pWith,
+    const char *pAt,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  int mode = 0;
+  
+  AKSVIEW *pv = NULL;
+  AKSVIEW *pl = NULL;
+  
+  int64_t start = 0;
+  int64_t flen = 0;
+  int64_t span[2];
+  
+  uint8_t *pBlk = NULL;
+  uint8_t *pRun = NULL;
+  char *pLine = NULL;
+  
+  CACHE_DROP cd;
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  memset(&cd, 0, sizeof(CACHE_DROP));
+  cd.fd = -1;
+  lk.fd = -1;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pWith == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the mode, if provided */
+  if (pIn != NULL) {
+    mode = parseMode(pIn, scanModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse scan mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Get the starting address, if provided */
+  if (status && (pAt != NULL)) {
+    start = binpoke_parseaddress(pAt);
+    if (start < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse address: %s\n",
+                pModule, pAt);
+    }
+  }
+  
+  /* Open the listing */
+  if (status) {
+    pl = aksview_create(pWith, AKSVIEW_READONLY, &errcode);
+    if (pl == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open listing: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
+  }
+  
+  /* Open a read-write view of the data file */
+  if (status) {
+    pv = aksview_create(pPath, AKSVIEW_EXISTING, &errcode);
+    if (pv == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, aksview_errstr(errcode));
+    } else {
+      flen = aksview_getlen(pv);
+    }
+  }
+  
+  /* Take buffers from the pool */
+  if (status) {
+    pBlk = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    if (pBlk != NULL) {
+      pRun = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    }
+    if (pRun != NULL) {
+      pLine = (char *) bufAlloc(LINE_MAXLEN + 1);
+    }
+    if (pLine == NULL) {
+      status = 0;
+    }
+  }
+  
+  /* Check the whole listing, lock the span of addresses it touches for
+   * writing, and then import it */
+  if (status) {
+    status = importPass(pl, NULL, NULL, flen, start, pBlk, pRun, pLine,
+                          span);
+  }
+  if (status) {
+    status = lockRange(&lk, pPath, span[0], span[1] - span[0], 1,
+                        mode & LOCK_MODE_WAIT);
+  }
+  if (status) {
+    cacheOpen(&cd, pPath, mode & SCAN_MODE_NOCACHE);
+    status = importPass(pl, pv, &cd, flen, start, pBlk, pRun, pLine,
+                          NULL);
+  }
+  
+  /* Release buffers and locks, and close views and cache dropper */
+  bufFree(pBlk);
+  bufFree(pRun);
+  bufFree(pLine);
+  aksview_close(pl);
+  aksview_close(pv);
+  cacheClose(&cd);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to combine a range of bytes with a repeating key using a bitwise
+ * operation.
+ * 
+ * Without a type, the key is a string of base-16 digits giving the key
+ * bytes.  With a type, the key is an integer value of that type, and the
+ * count must be a whole number of integers.  The key repeats from the
+ * start of the range.
+ * 
+ * Without a target, the range is transformed in place.  With a target,
+ * the file is only read, and the target is created if necessary, set
+ * to the length of the range, and filled with the transformed range.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pFrom - string parameter with the starting address
+ * 
+ *   pFor - string parameter with the byte count
+ * 
+ *   pWith - string parameter with the key
+ * 
+ *   pAs - string parameter with the key type, or NULL for a key of
+ *   base-16 digits
+ * 
+ *   pIn - string parameter with the transform mode, or NULL for the
+ *   default mode
+ * 
+ *   pTo - the path to the target file, or NULL to transform in place
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_xform(
+    const char *pPath,
+    const char *pFrom,
+    const char *pFor,
+    const char *pWith,
+    const char *pAs,
+    const char *pIn,
+    const char *pTo) {
+  
+  int status = 1;
+  int errcode = 0;
+  int mode = 0;
+  int ops = 0;
+  AKSVIEW *pv = NULL;
+  AKSVIEW *pt = NULL;
+  
+  int64_t addr = 0;
+  int64_t count = 0;
+  int64_t p = 0;
+  int32_t blen = 0;
+  int32_t i = 0;
+  int32_t klen = 0;
+  int hi = 0;
+  int lo = 0;
+  
+  const BINPOKE_TYPE *pType = NULL;
+  uint64_t v = 0;
+  uint8_t key[XFORM_MAXKEY];
+  
+  uint8_t *pBuf = NULL;
+  uint8_t *pPat = NULL;
+  
+  CACHE_DROP cd;
+  RANGE_LOCK lk;
+  RANGE_LOCK lt;
+  
+  /* Initialize structures */
+  memset(&cd, 0, sizeof(CACHE_DROP));
+  cd.fd = -1;
+  lk.fd = -1;
+  lt.fd = -1;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pFrom == NULL) || (pFor == NULL) ||
+      (pWith == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the address */
+  addr = binpoke_parseaddress(pFrom);
+  if (addr < 0) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to parse address: %s\n",
+              pModule, pFrom);
+  }
+  
+  /* Get the count */
+  if (status) {
+    count = binpoke_parsecount(pFor);
+    if (count < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse count: %s\n",
+                pModule, pFor);
+    }
+  }
+  
+  /* Get the mode, if provided */
+  if (status && (pIn != NULL)) {
+    mode = parseMode(pIn, xformModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse transform mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Check that at most one operation is given, which is when clearing
+   * the lowest operation flag leaves none */
+  ops = mode & (XFORM_MODE_AND | XFORM_MODE_OR | XFORM_MODE_XOR);
+  if (status && ((ops & (ops - 1)) != 0)) {
+    status = 0;
+    fprintf(stderr, "%s: Can't combine transform operations!\n",
+              pModule);
+  }
+  
+  /* Get the key, either as an integer of a given type or as a string of
+   * base-16 digits */
+  if (status && (pAs != NULL)) {
+    pType = binpoke_parsetype(pAs);
+    if (pType == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Unrecognized type: %s\n", pModule, pAs);
+    }
+    
+    if (status) {
+      if (!binpoke_parsevalue(pWith, pType, &v)) {
+        status = 0;
+        fprintf(stderr, "%s: Invalid value for type %s: %s\n",
+                  pModule, pAs, pWith);
+      }
+    }
+    
+    if (status) {
+      binpoke_encode(key, pType, v);
+      klen = pType->width;
+      if (count % klen != 0) {
+        status = 0;
+        fprintf(stderr, "%s: Count is not a multiple of type width!\n",
+                  pModule);
+      }
+    }
+    
+  } else if (status) {
+    for(klen = 0; pWith[2 * klen] != 0; klen++) {
+      hi = hexDigit(pWith[2 * klen]);
+      lo = -1;
+      if (hi >= 0) {
+        lo = hexDigit(pWith[(2 * klen) + 1]);
+      }
+      if ((lo < 0) || (klen >= XFORM_MAXKEY)) {
+        status = 0;
+        fprintf(stderr, "%s: Key must be 1 to %d bytes of hex digits: "
+                  "%s\n", pModule, XFORM_MAXKEY, pWith);
+        break;
+      }
+      key[klen] = (uint8_t) ((hi << 4) | lo);
+    }
+    
+    if (status && (klen < 1)) {
+      status = 0;
+      fprintf(stderr, "%s: Key must be 1 to %d bytes of hex digits: "
+                "%s\n", pModule, XFORM_MAXKEY, pWith);
+    }
+  }
+  
+  /* Check that the target is not the file itself, since it would be
+   * cut short before it is read */
+  if (status && (pTo != NULL)) {
+    if (sameFile(pPath, pTo)) {
+      status = 0;
+      fprintf(stderr, "%s: Target is the same file as the source!\n",
+                pModule);
+    }
+  }
+  
+  /* Open the file, which is only read if there is a target */
+  if (status) {
+    if (pTo != NULL) {
+      pv = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
+    } else {
+      pv = aksview_create(pPath, AKSVIEW_EXISTING, &errcode);
+    }
+    if (pv == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
+  }
+  
+  /* Check that the range is within file limits */
+  if (status) {
+    if ((addr > aksview_getlen(pv)) ||
+        (count > aksview_getlen(pv) - addr)) {
+      status = 0;
+      fprintf(stderr, "%s: Given byte range goes beyond end of file!\n",
+                pModule);
+    }
+  }
+  
+  /* Lock the range, only for reading if there is a target */
+  if (status) {
+    status = lockRange(&lk, pPath, addr, count, (pTo == NULL),
+                        mode & LOCK_MODE_WAIT);
+  }
+  
+  /* Take the block buffer, and the pattern buffer filled with the
+   * key repeated, with one extra key length so that a block can start
+   * at any phase of the key, before the target is touched */
+  if (status) {
+    pBuf = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    if (pBuf != NULL) {
+      pPat = (uint8_t *) bufAlloc(BLOCK_SIZE + XFORM_MAXKEY);
+    }
+    if (pPat != NULL) {
+      for(i = 0; i < BLOCK_SIZE + klen; i++) {
+        pPat[i] = key[i % klen];
+      }
+    } else {
+      status = 0;
+    }
+  }
+  
+  /* Open the target, if there is one, lock all of it for writing, and
+   * set its length */
+  if (status && (pTo != NULL)) {
+    pt = aksview_create(pTo, AKSVIEW_REGULAR, &errcode);
+    if (pt == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open target file: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
+    
+    if (status) {
+      status = lockRange(&lt, pTo, 0, LOCK_TO_END, 1,
+                          mode & LOCK_MODE_WAIT);
+    }
+    
+    if (status) {
+      if (!aksview_setlen(pt, count)) {
+        status = 0;
+        fprintf(stderr, "%s: Failed to set length on target file!\n",
+                  pModule);
+      }
+    }
+  }
+  
+  /* Transform each block */
+  if (status) {
+    cacheOpen(&cd, pPath, mode & SCAN_MODE_NOCACHE);
+    for(p = 0; p < count; p += blen) {
+      /* Get the length of this block */
+      if (count - p < BLOCK_SIZE) {
+        blen = (int32_t) (count - p);
+      } else {
+        blen = BLOCK_SIZE;
+      }
+      
+      /* Read the block, transform it, and write it to the file or the
+       * target */
+      readBlock(pv, addr + p, pBuf, blen);
+      xformBlock(pBuf, pPat + ((int32_t) (p % klen)), blen, mode);
+      if (pt != NULL) {
+        writeBlock(pt, p, pBuf, blen);
+      } else {
+        writeBlock(pv, addr + p, pBuf, blen);
+      }
+      cacheDrop(&cd, addr + p, blen);
+    }
+  }
+  
+  /* Release buffers and locks, and close viewers and cache dropper if
+   * open */
+  bufFree(pBuf);
+  bufFree(pPat);
+  aksview_close(pt);
+  aksview_close(pv);
+  cacheClose(&cd);
+  lockRelease(&lt);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to walk a chain of length-prefixed chunks.
+ * 
+ * The chunks start at the given address and follow each other up to
+ * the end of the range, with the layout described for parseLayout().
+ * Only the header of each chunk is read, so payloads are never touched.
+ * 
+ * In table mode, a table of the chunks is printed with printChunk().
+ * In index mode, the table is instead written to the chunk index, so
+ * that the chunk verb can look up any chunk directly.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pAt - string parameter with the address of the first chunk
+ * 
+ *   pAs - string parameter with the chunk layout
+ * 
+ *   pFor - string parameter with the length of the range to walk, or
+ *   NULL to walk to the end of the file
+ * 
+ *   pIn - string parameter with the walk mode, or NULL for the default
+ *   mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_walk(
+    const char *pPath,
+    const char *pAt,
+    const char *pAs,
+    const char *pFor,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  int mode = 0;
+  int j = 0;
+  
+  AKSVIEW *pv = NULL;
+  AKSVIEW *pc = NULL;
+  char *pCPath = NULL;
+  
+  int64_t addr = 0;
+  int64_t count = 0;
+  int64_t flen = 0;
+  int64_t end = 0;
+  int64_t pos = 0;
+  int64_t last = 0;
+  int64_t r = 0;
+  int64_t n = 0;
+  int64_t cap = 0;
+  int64_t plen = 0;
+  int64_t stamp = 0;
+  uint64_t lv = 0;
+  uint64_t tag = 0;
+  
+  uint8_t hbuf[CHUNK_MAXHEAD];
+  CHUNK_LAYOUT lay;
+  CACHE_DROP cd;
+  
+  /* Initialize structures */
+  memset(&lay, 0, sizeof(CHUNK_LAYOUT));
+  memset(&cd, 0, sizeof(CACHE_DROP));
+  cd.fd = -1;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pAt == NULL) || (pAs == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the address */
+  addr = binpoke_parseaddress(pAt);
+  if (addr < 0) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to parse address: %s\n",
+              pModule, pAt);
+  }
+  
+  /* Get the layout */
+  if (status) {
+    if (!parseLayout(pAs, &lay)) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse chunk layout: %s\n",
+                pModule, pAs);
+    }
+  }
+  
+  /* Get the count, if provided */
+  if (status && (pFor != NULL)) {
+    count = binpoke_parsecount(pFor);
+    if (count < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse count: %s\n",
+                pModule, pFor);
+    }
+  }
+  
+  /* Get the mode, if provided */
+  if (status && (pIn != NULL)) {
+    mode = parseMode(pIn, walkModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse walk mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Open a read-only view */
+  if (status) {
+    pv = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
+    if (pv == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, aksview_errstr(errcode));
+    } else {
+      flen = aksview_getlen(pv);
+      stamp = fileStamp(pPath);
+    }
+  }
+  
+  /* Get the end of the range and check that it is within file
+   * limits */
+  if (status) {
+    if (pFor == NULL) {
+      count = flen - addr;
+    }
+    if ((addr > flen) || (count < 0) || (count > flen - addr)) {
+      status = 0;
+      fprintf(stderr, "%s: Given byte range goes beyond end of file!\n",
+                pModule);
+    } else {
+      end = addr + count;
+    }
+  }
+  
+  /* In index mode, open the chunk index and empty it */
+  if (status && (mode & WALK_MODE_INDEX)) {
+    pCPath = sidecarPath(pPath, WALK_SUFFIX);
+    pc = aksview_create(pCPath, AKSVIEW_REGULAR, &errcode);
+    if (pc == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open chunk index: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
+    
+    if (status) {
+      if (!aksview_setlen(pc, 0)) {
+        status = 0;
+        fprintf(stderr, "%s: Failed to set length on chunk index!\n",
+                  pModule);
+      }
+    }
+  }
+  
+  /* Follow the chain of chunks */
+  if (status) {
+    cacheOpen(&cd, pPath, mode & SCAN_MODE_NOCACHE);
+  }
+  for(pos = addr; status && (pos < end); n++) {
+    /* Read the header */
+    if (end - pos < lay.head) {
+      status = 0;
+      fprintf(stderr, "%s: Header of chunk ", pModule);
+      fprintInt64(stderr, n);
+      fprintf(stderr, " at offset ");
+      fprintInt64(stderr, pos);
+      fprintf(stderr, " goes beyond end of range!\n");
+      break;
+    }
+    readBlock(pv, pos, hbuf, lay.head);
+    
+    /* Decode the tag and the length */
+    if (lay.pTag != NULL) {
+      tag = binpoke_decode(hbuf + lay.tag_off, lay.pTag);
+    }
+    lv = binpoke_decode(hbuf + lay.len_off, lay.pLen);
+    
+    /* Get the payload length, which must not be negative */
+    if ((lay.pLen->sgn) &&
+        ((lv >> ((8 * lay.pLen->width) - 1)) & 0x1)) {
+      status = 0;
+    } else if (lv > (uint64_t) INT64_MAX) {
+      status = 0;
+    } else {
+      plen = (int64_t) lv;
+    }
+    
+    if (status && lay.inclusive) {
+      if (plen < lay.head) {
+        status = 0;
+      } else {
+        plen -= lay.head;
+      }
+    }
+    
+    if (!status) {
+      fprintf(stderr, "%s: Chunk ", pModule);
+      fprintInt64(stderr, n);
+      fprintf(stderr, " at offset ");
+      fprintInt64(stderr, pos);
+      fprintf(stderr, " has invalid length!\n");
+      break;
+    }
+    
+    /* Check that the whole chunk is within the range */
+    r = end - pos - lay.head;
+    if ((plen > r) || (lay.tail > r - plen)) {
+      status = 0;
+      fprintf(stderr, "%s: Chunk ", pModule);
+      fprintInt64(stderr, n);
+      fprintf(stderr, " at offset ");
+      fprintInt64(stderr, pos);
+      fprintf(stderr, " goes beyond end of range!\n");
+      break;
+    }
+    
+    /* Print the chunk, or record it in the chunk index, growing the
+     * index by doubling */
+    if (pc != NULL) {
+      if (n >= cap) {
+        if (cap < 1) {
+          cap = 64;
+        } else {
+          cap *= 2;
+        }
+        if (!aksview_setlen(pc, WALK_HEADER + (cap * WALK_RECORD))) {
+          status = 0;
+          fprintf(stderr, "%s: Failed to set length on chunk index!\n",
+                    pModule);
+          break;
+        }
+      }
+      writeInt(pc, WALK_HEADER + (n * WALK_RECORD),
+                pSidecarType, (uint64_t) pos);
+      writeInt(pc, WALK_HEADER + (n * WALK_RECORD) + 8,
+                pSidecarType, tag);
+      writeInt(pc, WALK_HEADER + (n * WALK_RECORD) + 16,
+                pSidecarType, (uint64_t) plen);
+      
+    } else {
+      printChunk(n, pos, lay.pTag, tag, plen);
+    }
+    
+    /* Move to the next chunk, padding to the alignment; padding after
+     * the last chunk may be missing */
+    last = pos;
+    pos += lay.head + plen + lay.tail;
+    r = (pos - addr) % lay.align;
+    if (r != 0) {
+      if (end - pos < lay.align - r) {
+        pos = end;
+      } else {
+        pos += lay.align - r;
+      }
+    }
+    
+    /* Drop the cached pages of the whole chunk, so that pages read
+     * ahead past the header go too, and the chunks merge into one
+     * range */
+    cacheDrop(&cd, last, pos - last);
+  }
+  
+  /* In index mode, trim the index, write the header last so an
+   * interrupted walk leaves an incomplete index, and report the
+   * count */
+  if (status && (pc != NULL)) {
+    if (!aksview_setlen(pc, WALK_HEADER + (n * WALK_RECORD))) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to set length on chunk index!\n",
+                pModule);
+    }
+    
+    if (status) {
+      writeInt(pc, 8, pSidecarType, (uint64_t) flen);
+      writeInt(pc, 16, pSidecarType, (uint64_t) n);
+      if (lay.pTag != NULL) {
+        writeInt(pc, 24, pSidecarType, (uint64_t) lay.pTag->width);
+        writeInt(pc, 32, pSidecarType, (uint64_t) lay.pTag->big);
+      } else {
+        writeInt(pc, 24, pSidecarType, 0);
+        writeInt(pc, 32, pSidecarType, 0);
+      }
+      writeInt(pc, 40, pSidecarType, (uint64_t) stamp);
+      for(j = 0; j < 8; j++) {
+        aksview_write8(pc, j, (WALK_SIGNATURE)[j]);
+      }
+      
+      printf("Chunks indexed: ");
+      printInt64(n);
+      printf("\n");
+    }
+  }
+  
+  /* Release path, and close viewers and cache dropper if open */
+  free(pCPath);
+  aksview_close(pc);
+  aksview_close(pv);
+  cacheClose(&cd);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to look up a single chunk in the chunk index written by the walk
+ * verb.
+ * 
+ * The chunk is printed with printChunk().  Only the chunk index is
+ * read, and the index is refused if the file length has changed since
+ * it was written.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pAt - string parameter with the chunk number
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_chunk(const char *pPath, const char *pAt) {
+  
+  int status = 1;
+  int errcode = 0;
+  AKSVIEW *pv = NULL;
+  AKSVIEW *pc = NULL;
+  
+  int64_t n = 0;
+  int64_t flen = 0;
+  int64_t cnt = 0;
+  int64_t rpos = 0;
+  const BINPOKE_TYPE *pt = NULL;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pAt == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the chunk number */
+  n = binpoke_parsecount(pAt);
+  if (n < 0) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to parse chunk number: %s\n",
+              pModule, pAt);
+  }
+  
+  /* Get the file length */
+  if (status) {
+    pv = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
+    if (pv == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, aksview_errstr(errcode));
+    } else {
+      flen = aksview_getlen(pv);
+    }
+  }
+  
+  /* Open the chunk index */
+  if (status) {
+    pc = chunkOpen(pPath, flen, &cnt, &pt);
+    if (pc == NULL) {
+      status = 0;
+    }
   }
   
-  /* Fail if empty string */
-  if (*pstr == 0) {
-    result = -1;
+  /* Check the chunk number */
+  if (status && (n >= cnt)) {
+    status = 0;
+    fprintf(stderr, "%s: Chunk number is beyond the last chunk!\n",
+              pModule);
+  }
+  
+  /* Print the chunk */
+  if (status) {
+    rpos = WALK_HEADER + (n * WALK_RECORD);
+    printChunk(n,
+      (int64_t) readInt(pc, rpos, pSidecarType),
+      pt,
+      readInt(pc, rpos + 8, pSidecarType),
+      (int64_t) readInt(pc, rpos + 16, pSidecarType));
+  }
+  
+  /* Close viewers if open */
+  aksview_close(pc);
+  aksview_close(pv);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to print the runs of printable characters within a range of a
+ * file.
+ * 
+ * Each run of at least the minimum length is printed on its own line,
+ * as the file offset of the run in decimal, a tab, and the text of the
+ * run.  Printable characters are the same as in a listing.  Runs are
+ * clipped to the range.
+ * 
+ * The range is streamed through a buffer of BLOCK_SIZE bytes.  A run
+ * that crosses the end of a block is carried over into the next block,
+ * holding back its first bytes until it is known to be long enough.
+ * Between runs, stringsSkip() passes over binary data and runs that are
+ * too short.
+ * 
+ * The scan is a single pass in file order.  The output must come out
+ * in file order, and it can be as long as the range itself, so worker
+ * threads scanning separate sections would each have to hold the
+ * output of a whole section, outside the buffer pool, until every
+ * section before it had been printed.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pFrom - string parameter with the starting address
+ * 
+ *   pFor - string parameter with the byte count
+ * 
+ *   pWith - string parameter with the minimum run length, or NULL for
+ *   the default of STRINGS_MINLEN
+ * 
+ *   pIn - string parameter with the scan mode, or NULL for the default
+ *   mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_strings(
+    const char *pPath,
+    const char *pFrom,
+    const char *pFor,
+    const char *pWith,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  int mode = 0;
+  AKSVIEW *pv = NULL;
+  
+  int64_t addr = 0;
+  int64_t count = 0;
+  int64_t minlen = STRINGS_MINLEN;
+  
+  int64_t p = 0;
+  int32_t blen = 0;
+  int32_t i = 0;
+  int32_t j = 0;
+  int64_t run_addr = 0;
+  int64_t run_len = 0;
+  
+  uint8_t *pBuf = NULL;
+  uint8_t *pFlag = NULL;
+  uint8_t *pHold = NULL;
+  
+  CACHE_DROP cd;
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  memset(&cd, 0, sizeof(CACHE_DROP));
+  cd.fd = -1;
+  lk.fd = -1;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (pFrom == NULL) || (pFor == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Get the address */
+  addr = binpoke_parseaddress(pFrom);
+  if (addr < 0) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to parse address: %s\n",
+              pModule, pFrom);
+  }
+  
+  /* Get the count */
+  if (status) {
+    count = binpoke_parsecount(pFor);
+    if (count < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse count: %s\n",
+                pModule, pFor);
+    }
+  }
+  
+  /* Get the minimum run length, if provided */
+  if (status && (pWith != NULL)) {
+    minlen = binpoke_parsecount(pWith);
+    if (minlen < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse count: %s\n",
+                pModule, pWith);
+    }
+  }
+  
+  if (status && ((minlen < 1) || (minlen > STRINGS_MAXMIN))) {
+    status = 0;
+    fprintf(stderr, "%s: Minimum run length must be 1 to %d!\n",
+              pModule, STRINGS_MAXMIN);
+  }
+  
+  /* Get the mode, if provided */
+  if (status && (pIn != NULL)) {
+    mode = parseMode(pIn, scanModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse scan mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Open a read-only view */
+  if (status) {
+    pv = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
+    if (pv == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
+  }
+  
+  /* Check that the range is within file limits */
+  if (status) {
+    if ((addr > aksview_getlen(pv)) ||
+        (count > aksview_getlen(pv) - addr)) {
+      status = 0;
+      fprintf(stderr, "%s: Given byte range goes beyond end of file!\n",
+                pModule);
+    }
+  }
+  
+  /* Lock the range for reading */
+  if (status) {
+    status = lockRange(&lk, pPath, addr, count, 0,
+                        mode & LOCK_MODE_WAIT);
   }
   
-  /* Skip any leading zeros */
-  if (result >= 0) {
-    for( ; *pstr == '0'; pstr++);
+  /* Take the block buffer, the flag buffer, and the buffer for the
+   * held-back start of a run */
+  if (status) {
+    pBuf = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    if (pBuf != NULL) {
+      pFlag = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    }
+    if (pFlag != NULL) {
+      pHold = (uint8_t *) bufAlloc(STRINGS_MAXMIN);
+    }
+    if (pHold == NULL) {
+      status = 0;
+    }
   }
   
-  /* Parse any remaining digits */
-  if (result >= 0) {
-    for( ; *pstr != 0; pstr++) {
-      /* Check that digit is valid */
-      if ((*pstr < '0') || (*pstr > '9')) {
-        result = -1;
+  /* Scan each block */
+  if (status) {
+    cacheOpen(&cd, pPath, mode & SCAN_MODE_NOCACHE);
+    for(p = addr; p < addr + count; p += blen) {
+      /* Get the length of this block */
+      if (addr + count - p < BLOCK_SIZE) {
+        blen = (int32_t) (addr + count - p);
+      } else {
+        blen = BLOCK_SIZE;
       }
       
-      /* Multiply result by ten, failing if overflow */
-      if (result >= 0) {
-        if (result <= INT64_MAX / 10) {
-          result *= 10;
-        } else {
-          result = -1;
-        }
-      }
+      /* Read and classify the block */
+      readBlock(pv, p, pBuf, blen);
+      stringsClassify(pBuf, pFlag, blen);
       
-      /* Add new digit into result, failing if overflow */
-      if (result >= 0) {
-        if (result <= INT64_MAX - (*pstr - '0')) {
-          result += (*pstr - '0');
-        } else {
-          result = -1;
+      /* Go through alternating spans of printable and other bytes,
+       * skipping ahead to a long enough run when not in one */
+      for(i = 0; i < blen; i = j) {
+        if (run_len < 1) {
+          i = stringsSkip(pFlag, i, blen, (int32_t) minlen);
+        }
+        
+        /* Add the printable span to the current run; the run is printed
+         * as soon as it reaches the minimum length, and its start is
+         * held back until then */
+        j = stringsSpan(pFlag, i, blen, 1);
+        if (j > i) {
+          if (run_len < 1) {
+            run_addr = p + i;
+          }
+          
+          if (run_len >= minlen) {
+            fwrite(pBuf + i, 1, (size_t) (j - i), stdout);
+            
+          } else if (run_len + (j - i) >= minlen) {
+            printInt64(run_addr);
+            putchar('\t');
+            fwrite(pHold, 1, (size_t) run_len, stdout);
+            fwrite(pBuf + i, 1, (size_t) (j - i), stdout);
+            
+          } else {
+            memcpy(pHold + run_len, pBuf + i, (size_t) (j - i));
+          }
+          run_len += (j - i);
+        }
+        
+        /* A byte that is not printable ends the run, and is skipped
+         * along with any others following it */
+        if (j < blen) {
+          if (run_len >= minlen) {
+            putchar('\n');
+          }
+          run_len = 0;
+          j = stringsSpan(pFlag, j, blen, 0);
         }
       }
       
-      /* Leave loop if error */
-      if (result < 0) {
-        break;
+      cacheDrop(&cd, p, blen);
+    }
+    
+    /* End a run that goes to the end of the range */
+    if (run_len >= minlen) {
+      putchar('\n');
+    }
+  }
+  
+  /* Release buffers and locks, and close viewer and cache dropper if
+   * open */
+  bufFree(pBuf);
+  bufFree(pFlag);
+  bufFree(pHold);
+  aksview_close(pv);
+  cacheClose(&cd);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to write the block manifest of a file.
+ * 
+ * The file is divided into blocks of the block size, with a shorter
+ * last block if necessary, and the hash of each block is recorded in
+ * the block manifest along with the file length and, if it is known,
+ * the modification time of the file.  Any existing manifest is
+ * replaced.  The header is written last, so an interrupted run leaves
+ * an incomplete manifest.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   pWith - string parameter with the block size, or NULL for the
+ *   default of MANIFEST_BLOCK
+ * 
+ *   pIn - string parameter with the scan mode, or NULL for the default
+ *   mode
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_manifest(
+    const char *pPath,
+    const char *pWith,
+    const char *pIn) {
+  
+  int status = 1;
+  int errcode = 0;
+  int mode = 0;
+  int j = 0;
+  char *pMPath = NULL;
+  AKSVIEW *pv = NULL;
+  AKSVIEW *pm = NULL;
+  uint8_t *pBuf = NULL;
+  
+  int64_t bsize = MANIFEST_BLOCK;
+  int64_t flen = 0;
+  int64_t stamp = 0;
+  int64_t count = 0;
+  int64_t n = 0;
+  int64_t pos = 0;
+  int64_t blen = 0;
+  uint64_t h = 0;
+  
+  CACHE_DROP cd;
+  HOLE_MAP hm;
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  memset(&cd, 0, sizeof(CACHE_DROP));
+  cd.fd = -1;
+  memset(&hm, 0, sizeof(HOLE_MAP));
+  hm.fd = -1;
+  lk.fd = -1;
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Get the block size, if provided */
+  if (pWith != NULL) {
+    bsize = binpoke_parsecount(pWith);
+    if (bsize < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse count: %s\n",
+                pModule, pWith);
+    }
+  }
+  
+  if (status && ((bsize < BLOCK_SIZE) || (bsize > MANIFEST_MAXBLOCK) ||
+                  ((bsize % BLOCK_SIZE) != 0))) {
+    status = 0;
+    fprintf(stderr, "%s: Block size must be a multiple of ", pModule);
+    fprintInt64(stderr, BLOCK_SIZE);
+    fprintf(stderr, " up to ");
+    fprintInt64(stderr, MANIFEST_MAXBLOCK);
+    fprintf(stderr, "!\n");
+  }
+  
+  /* Get the mode, if provided */
+  if (status && (pIn != NULL)) {
+    mode = parseMode(pIn, scanModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse scan mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Open a read-only view */
+  if (status) {
+    pv = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
+    if (pv == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
+  }
+  
+  /* Lock the whole file for reading, and only then get its length and
+   * modification time, so that they match the bytes that are hashed */
+  if (status) {
+    status = lockRange(&lk, pPath, 0, LOCK_TO_END, 0,
+                        mode & LOCK_MODE_WAIT);
+  }
+  
+  if (status) {
+    flen = aksview_getlen(pv);
+    stamp = fileStamp(pPath);
+    count = (flen / bsize) + ((flen % bsize) != 0);
+  }
+  
+  /* Take the block buffer */
+  if (status) {
+    pBuf = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    if (pBuf == NULL) {
+      status = 0;
+    }
+  }
+  
+  /* Open the manifest, empty it, and make room for the records */
+  if (status) {
+    pMPath = sidecarPath(pPath, MANIFEST_SUFFIX);
+    pm = aksview_create(pMPath, AKSVIEW_REGULAR, &errcode);
+    if (pm == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open block manifest: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
+  }
+  
+  if (status) {
+    if ((!aksview_setlen(pm, 0)) ||
+        (!aksview_setlen(pm, MANIFEST_HEADER + (count * MANIFEST_RECORD)))) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to set length on block manifest!\n",
+                pModule);
+    }
+  }
+  
+  /* Hash each block */
+  if (status) {
+    cacheOpen(&cd, pPath, mode & SCAN_MODE_NOCACHE);
+    holeOpen(&hm, pPath);
+    for(n = 0; n < count; n++) {
+      pos = n * bsize;
+      if (flen - pos < bsize) {
+        blen = flen - pos;
+      } else {
+        blen = bsize;
       }
+      
+      h = hashRange(pv, &hm, &cd, pos, blen, pBuf);
+      writeInt(pm, MANIFEST_HEADER + (n * MANIFEST_RECORD),
+                pSidecarType, h);
     }
   }
   
-  /* Return result or -1 */
-  return result;
+  /* Write the header last, and report the count */
+  if (status) {
+    writeInt(pm, 8, pSidecarType, (uint64_t) flen);
+    writeInt(pm, 16, pSidecarType, (uint64_t) bsize);
+    writeInt(pm, 24, pSidecarType, (uint64_t) stamp);
+    for(j = 0; j < 8; j++) {
+      aksview_write8(pm, j, (MANIFEST_SIGNATURE)[j]);
+    }
+    
+    printf("Blocks hashed: ");
+    printInt64(count);
+    printf("\n");
+  }
+  
+  /* Release buffer, path, and locks, and close viewers, cache dropper,
+   * and hole map if open */
+  bufFree(pBuf);
+  free(pMPath);
+  aksview_close(pm);
+  aksview_close(pv);
+  cacheClose(&cd);
+  holeClose(&hm);
+  lockRelease(&lk);
+  
+  /* Return status */
+  return status;
 }
 
 /*
- * Parse a sequence of base-16 digits as an unsigned value.
+ * Verb to print the ranges of a file that have changed since its block
+ * manifest was written.
  * 
- * pstr must point to a sequence of at least one base-16 character.
+ * Each block of the file is hashed and compared to its record in the
+ * manifest.  Each run of consecutive changed blocks is printed on its
+ * own line as the file offset and the length of the run in decimal,
+ * separated by a tab, clipped to the current file length.  Blocks
+ * beyond the old end of the file, and a last block whose length has
+ * changed, are always reported.  If the file has become shorter, the
+ * bytes cut off from the old end are reported last, on a line of their
+ * own with a third field of "truncated".
  * 
- * The result will be stored in *pv.  If parsing fails, an undefined
- * value will be in *pv.  Check the return to determine whether parsing
- * succeeded or not.
+ * Unless the mode includes CHANGED_MODE_FULL, nothing is hashed if the
+ * file length and the modification time recorded in the manifest both
+ * still match the file, since then nothing can have changed.  If the
+ * mode includes CHANGED_MODE_UPDATE, the manifest is then brought up to
+ * date, rewriting only the records of changed blocks.
+ * 
+ * The blocks are hashed in rounds by a pool of workers, which only has
+ * more than one worker when compiled with BINPOKE_THREADS.  Each round
+ * is compared, recorded, and printed in block order once it is hashed.
  * 
  * Parameters:
  * 
- *   pstr - the string to parse
+ *   pPath - the path to the file
  * 
- *   pv - pointer to variable to receive parsed result
+ *   pIn - string parameter with the changed mode, or NULL for the
+ *   default mode
  * 
  * Return:
  * 
  *   non-zero if successful, zero if error
  */
-static int parseHex(const char *pstr, uint64_t *pv) {
+static int verb_changed(const char *pPath, const char *pIn) {
   
   int status = 1;
-  int d = 0;
+  int errcode = 0;
+  int mode = 0;
+  int same = 0;
+  int diff = 0;
+  int j = 0;
+  AKSVIEW *pv = NULL;
+  AKSVIEW *pm = NULL;
+  
+  int64_t bsize = 0;
+  int64_t olen = 0;
+  int64_t ostamp = 0;
+  int64_t flen = 0;
+  int64_t stamp = 0;
+  int64_t ocount = 0;
+  int64_t count = 0;
+  int64_t n = 0;
+  int64_t base = 0;
+  int64_t end = 0;
+  int64_t round = 0;
+  int64_t pos = 0;
+  int64_t blen = 0;
+  int64_t oblen = 0;
+  int64_t run_pos = 0;
+  int64_t run_len = 0;
+  uint64_t h = 0;
+  
+  HASH_POOL hp;
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  memset(&hp, 0, sizeof(HASH_POOL));
+  lk.fd = -1;
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Get the mode, if provided */
+  if (pIn != NULL) {
+    mode = parseMode(pIn, changedModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse changed mode: %s\n",
+                pModule, pIn);
+    }
+  }
+  
+  /* Open a read-only view */
+  if (status) {
+    pv = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
+    if (pv == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open file: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
+  }
+  
+  /* Open the manifest */
+  if (status) {
+    pm = manifestOpen(pPath, mode & CHANGED_MODE_UPDATE,
+                        &olen, &bsize, &ostamp);
+    if (pm == NULL) {
+      status = 0;
+    }
+  }
+  
+  /* Lock the whole file for reading, and only then get its length and
+   * modification time */
+  if (status) {
+    status = lockRange(&lk, pPath, 0, LOCK_TO_END, 0,
+                        mode & LOCK_MODE_WAIT);
+  }
+  
+  if (status) {
+    flen = aksview_getlen(pv);
+    stamp = fileStamp(pPath);
+    ocount = (olen / bsize) + ((olen % bsize) != 0);
+    count = (flen / bsize) + ((flen % bsize) != 0);
+  }
   
-  /* Check parameters */
-  if ((pstr == NULL) || (pv == NULL)) {
-    fault(__LINE__);
+  /* Nothing can have changed if the length and a known modification
+   * time are both the same, so there is nothing to hash or update,
+   * unless every block is to be hashed */
+  if (status && (!(mode & CHANGED_MODE_FULL)) && (flen == olen) &&
+      (ostamp != 0) && (stamp == ostamp)) {
+    same = 1;
   }
   
-  /* Reset result to zero */
-  *pv = 0;
+  /* Open the hash workers, which take the block buffers */
+  if (status && (!same)) {
+    status = hashPoolOpen(&hp, pv, pPath, mode & SCAN_MODE_NOCACHE,
+                            bsize, flen);
+  }
   
-  /* Fail if empty string */
-  if (*pstr == 0) {
-    status = 0;
+  /* In update mode, spoil the signature so an interrupted update leaves
+   * an incomplete manifest, and then give the manifest one record for
+   * each block of the file */
+  if (status && (!same) && (mode & CHANGED_MODE_UPDATE)) {
+    aksview_write8(pm, 0, 0);
+    if (!aksview_setlen(pm, MANIFEST_HEADER + (count * MANIFEST_RECORD))) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to set length on block manifest!\n",
+                pModule);
+    }
   }
   
-  /* Parse all digits */
-  if (status) {
-    for( ; *pstr != 0; pstr++) {
-      /* Get current digit value */
-      if ((*pstr >= '0') && (*pstr <= '9')) {
-        d = *pstr - '0';
-      } else if ((*pstr >= 'a') && (*pstr <= 'f')) {
-        d = *pstr - 'a' + 10;
-      } else if ((*pstr >= 'A') && (*pstr <= 'F')) {
-        d = *pstr - 'A' + 10;
-      } else {
-        status = 0;
+  /* Hash the blocks that can be compared or must be recorded a round
+   * at a time, and then go through the round in block order, printing
+   * the runs of changed blocks */
+  if (status && (!same)) {
+    round = ((int64_t) hp.count) * HASH_ROUND;
+    for(base = 0; base < count; base = end) {
+      end = base + round;
+      if (end > count) {
+        end = count;
       }
       
-      /* Multiply result by 16, watching for overflow */
-      if (status) {
-        if (*pv <= UINT64_MAX / 16) {
-          *pv *= 16;
-        } else {
-          status = 0;
-        }
+      /* A block can only be compared if it had the same length
+       * before */
+      for(n = base; n < end; n++) {
+        blen = blockLen(n, bsize, flen);
+        oblen = blockLen(n, bsize, olen);
+        hp.need[n - base] = (uint8_t) (((n < ocount) && (oblen == blen)) ||
+                                        (mode & CHANGED_MODE_UPDATE));
       }
+      hashPoolRun(&hp, base, end);
       
-      /* Add digit into result, watching for overflow */
-      if (status) {
-        if (*pv <= UINT64_MAX - d) {
-          *pv += d;
-        } else {
-          status = 0;
+      for(n = base; n < end; n++) {
+        pos = n * bsize;
+        blen = blockLen(n, bsize, flen);
+        oblen = blockLen(n, bsize, olen);
+        h = hp.hash[n - base];
+        
+        diff = 1;
+        if ((n < ocount) && (oblen == blen)) {
+          diff = (h != readInt(pm,
+                                MANIFEST_HEADER + (n * MANIFEST_RECORD),
+                                pSidecarType));
+        }
+        
+        /* Record a changed block and add it to the current run, printing
+         * the run before it if this block does not extend it */
+        if (diff) {
+          if (mode & CHANGED_MODE_UPDATE) {
+            writeInt(pm, MANIFEST_HEADER + (n * MANIFEST_RECORD),
+                      pSidecarType, h);
+          }
+          
+          if ((run_len > 0) && (run_pos + run_len != pos)) {
+            printInt64(run_pos);
+            putchar('\t');
+            printInt64(run_len);
+            putchar('\n');
+            run_len = 0;
+          }
+          if (run_len < 1) {
+            run_pos = pos;
+          }
+          run_len += blen;
         }
       }
-      
-      /* Leave loop if error */
-      if (!status) {
-        break;
-      }
+    }
+    
+    /* Print the last run */
+    if (run_len > 0) {
+      printInt64(run_pos);
+      putchar('\t');
+      printInt64(run_len);
+      putchar('\n');
+    }
+    
+    /* Print the range cut off the end if the file is now shorter */
+    if (flen < olen) {
+      printInt64(flen);
+      putchar('\t');
+      printInt64(olen - flen);
+      printf("\ttruncated\n");
+    }
+  }
+  
+  /* In update mode, write the header and restore the signature */
+  if (status && (!same) && (mode & CHANGED_MODE_UPDATE)) {
+    writeInt(pm, 8, pSidecarType, (uint64_t) flen);
+    writeInt(pm, 24, pSidecarType, (uint64_t) stamp);
+    for(j = 0; j < 8; j++) {
+      aksview_write8(pm, j, (MANIFEST_SIGNATURE)[j]);
     }
   }
   
+  /* Close viewers, release the hash workers and locks */
+  aksview_close(pm);
+  aksview_close(pv);
+  hashPoolClose(&hp);
+  lockRelease(&lk);
+  
   /* Return status */
   return status;
 }
 
 /*
- * Parse an address encoded within a given string.
- * 
- * If the given string does not begin with "0x" or "0X" then this call
- * is equivalent to parseCount().
- * 
- * If the given string begins with "0x" or "0X" then parseHex() is
- * called on the rest of the string after the prefix.  If the unsigned
- * value returned from that is within 64-bit signed range, then that is
- * the result; otherwise, the function returns a failure code of -1.
- * 
- * Parameters:
- * 
- *   pstr - the string to parse
+ * Verb to make a file into an exact copy of a source file, writing only
+ * the pages that differ.
  * 
- * Return:
+ * The file is first resized to the length of the source, so that bytes
+ * beyond the old end of the file are zero.  Both files are then
+ * streamed through buffers of BLOCK_SIZE bytes, and each run of pages
+ * that differ is written to the file.  Bytes beyond the old end of the
+ * file, and holes found by the hole maps, are known to be zero and are
+ * not read.  Zero pages of the source are therefore never written over
+ * zero pages of the file, so the holes of the file are kept.
  * 
- *   the parsed address, or -1 if parsing error
- */
-static int64_t parseAddress(const char *pstr) {
-  
-  int64_t result = 0;
-  uint64_t uv = 0;
-  
-  /* Check parameter */
-  if (pstr == NULL) {
-    fault(__LINE__);
-  }
-  
-  /* Handle cases */
-  if (strlen(pstr) < 2) {
-    /* Less than two characters in string, so no possible way there
-     * could be a prefix; call through to parseCount() */
-    result = parseCount(pstr);
-    
-  } else if ((pstr[0] != '0') ||
-                ((pstr[1] != 'x') && (pstr[1] != 'X'))) {
-    /* Does not begin with a prefix, so call through to parseCount() */
-    result = parseCount(pstr);
-    
-  } else {
-    /* If we got here, we have a prefix, so parse everything after the
-     * prefix as a hex string */
-    if (parseHex(pstr + 2, &uv)) {
-      /* We now have the unsigned 64-bit value; check whether in
-       * range */
-      if (uv <= INT64_MAX) {
-        /* In range, so cast to signed to get result */
-        result = (int64_t) uv;
-        
-      } else {
-        /* Not in range, so parsing failed */
-        result = -1;
-      }
-      
-    } else {
-      /* Parsing failed */
-      result = -1;
-    }
-  }
-  
-  /* Return result or -1 */
-  return result;
-}
-
-/*
- * Verb to generate a hex dump listing.
+ * The number of bytes compared and the number of bytes written are
+ * printed at the end.
  * 
  * Parameters:
  * 
- *   pPath - path to the file
+ *   pPath - the path to the file to update
  * 
- *   pFrom - string parameter with starting address
+ *   pWith - string parameter with the path to the source file
  * 
- *   pFor - string parameter with byte count
+ *   pIn - string parameter with the scan mode, or NULL for the default
+ *   mode
  * 
  * Return:
  * 
  *   non-zero if successful, zero if error
  */
-static int verb_list(
+static int verb_mirror(
     const char *pPath,
-    const char *pFrom,
-    const char *pFor) {
+    const char *pWith,
+    const char *pIn) {
   
   int status = 1;
   int errcode = 0;
+  int mode = 0;
   AKSVIEW *pv = NULL;
+  AKSVIEW *ps = NULL;
+  uint8_t *pSrc = NULL;
+  uint8_t *pDst = NULL;
   
-  int64_t addr = 0;
-  int64_t count = 0;
-  
-  int i = 0;
+  int64_t slen = 0;
+  int64_t dlen = 0;
   int64_t p = 0;
-  int64_t p_first = 0;
-  int64_t p_last = 0;
+  int64_t written = 0;
+  int32_t blen = 0;
+  int32_t i = 0;
+  int32_t j = 0;
   
-  LIST_LINE ls;
+  CACHE_DROP cd;
+  CACHE_DROP cs;
+  HOLE_MAP hd;
+  HOLE_MAP hs;
+  RANGE_LOCK lk;
+  RANGE_LOCK ls;
   
   /* Initialize structures */
-  memset(&ls, 0, sizeof(LIST_LINE));
+  memset(&cd, 0, sizeof(CACHE_DROP));
+  cd.fd = -1;
+  memset(&cs, 0, sizeof(CACHE_DROP));
+  cs.fd = -1;
+  memset(&hd, 0, sizeof(HOLE_MAP));
+  hd.fd = -1;
+  memset(&hs, 0, sizeof(HOLE_MAP));
+  hs.fd = -1;
+  lk.fd = -1;
+  ls.fd = -1;
   
   /* Check parameters */
-  if ((pPath == NULL) || (pFrom == NULL) || (pFor == NULL)) {
+  if ((pPath == NULL) || (pWith == NULL)) {
     fault(__LINE__);
   }
   
-  /* Get the address */
-  addr = parseAddress(pFrom);
-  if (addr < 0) {
-    status = 0;
-    fprintf(stderr, "%s: Failed to parse address: %s\n",
-              pModule, pFrom);
+  /* Get the mode, if provided */
+  if (pIn != NULL) {
+    mode = parseMode(pIn, scanModes);
+    if (mode < 0) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to parse scan mode: %s\n",
+                pModule, pIn);
+    }
   }
   
-  /* Get the count */
+  /* Check that the source is not the file itself, since its two range
+   * locks would conflict with each other */
   if (status) {
-    count = parseCount(pFor);
-    if (count < 0) {
+    if (sameFile(pPath, pWith)) {
       status = 0;
-      fprintf(stderr, "%s: Failed to parse count: %s\n",
-                pModule, pFor);
+      fprintf(stderr, "%s: Can't mirror a file onto itself!\n",
+                pModule);
     }
   }
   
-  /* Check that count is at least one and does not exceed limit */
-  if (status && (count < 1)) {
-    status = 0;
-    fprintf(stderr, "%s: Count may not be less than one!\n", pModule);
-  }
-  
-  if (status && (count > LIST_MAXBYTES)) {
-    status = 0;
-    fprintf(stderr, "%s: Count exceeds LIST_MAXBYTES limit!\n",
-              pModule);
+  /* Open a read-only view of the source and a view of the file */
+  if (status) {
+    ps = aksview_create(pWith, AKSVIEW_READONLY, &errcode);
+    if (ps == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open source file: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
   }
   
-  /* Open a read-only view */
   if (status) {
-    pv = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
+    pv = aksview_create(pPath, AKSVIEW_EXISTING, &errcode);
     if (pv == NULL) {
       status = 0;
       fprintf(stderr, "%s: Failed to open file: %s\n",
@@ -545,93 +10938,120 @@ static int verb_list(
     }
   }
   
-  /* Check that address is within file limits */
+  /* Lock the whole source for reading and the whole file for writing,
+   * and only then get their lengths */
   if (status) {
-    if (addr >= aksview_getlen(pv)) {
-      status = 0;
-      fprintf(stderr, "%s: Given address is outside file limits!\n",
-                pModule);
-    }
+    status = lockRange(&ls, pWith, 0, LOCK_TO_END, 0,
+                        mode & LOCK_MODE_WAIT);
+  }
+  if (status) {
+    status = lockRange(&lk, pPath, 0, LOCK_TO_END, 1,
+                        mode & LOCK_MODE_WAIT);
   }
   
-  /* Check that address added to count does not exceed file length */
   if (status) {
-    if (addr + count > aksview_getlen(pv)) {
+    slen = aksview_getlen(ps);
+    dlen = aksview_getlen(pv);
+  }
+  
+  /* Take the source and file block buffers before anything is
+   * changed */
+  if (status) {
+    pSrc = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    if (pSrc != NULL) {
+      pDst = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    }
+    if (pDst == NULL) {
       status = 0;
-      fprintf(stderr, "%s: Given byte range goes beyond end of file!\n",
-                pModule);
     }
   }
   
-  /* Compute the first and last paragraph addresses that will be
-   * displayed in the listing */
-  if (status) {
-    p_first = addr / 16;
-    p_last  = (addr + count - 1) / 16;
-    
-    p_first *= 16;
-    p_last  *= 16;
+  /* Resize the file to the length of the source */
+  if (status && (dlen != slen)) {
+    if (!aksview_setlen(pv, slen)) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to set length on file!\n", pModule);
+    }
   }
   
-  /* Print a listing of each paragraph */
+  /* Compare each block and write the runs of pages that differ */
   if (status) {
-    for(p = p_first; p <= p_last; p += 16) {
-    
-      /* Write the paragraph number into the structure */
-      ls.para = (int32_t) ((p & INT64_C(0xffffffff)) / 16);
+    cacheOpen(&cs, pWith, mode & SCAN_MODE_NOCACHE);
+    cacheOpen(&cd, pPath, mode & SCAN_MODE_NOCACHE);
+    holeOpen(&hs, pWith);
+    holeOpen(&hd, pPath);
+    for(p = 0; p < slen; p += blen) {
+      /* Get the length of this block */
+      if (slen - p < BLOCK_SIZE) {
+        blen = (int32_t) (slen - p);
+      } else {
+        blen = BLOCK_SIZE;
+      }
       
-      /* Read each relevant byte, filling -1 for bytes outside the
-       * requested range */
-      for(i = 0; i < 16; i++) {
-        if (((p + ((int64_t) i)) >= addr) &&
-              ((p + ((int64_t) i)) < addr + count)) {
-          /* Byte is in range */
-          (ls.bv)[i] = (int) aksview_read8u(pv, p + ((int64_t) i));
-          
-        } else {
-          /* Byte is not in range */
-          (ls.bv)[i] = -1;
+      /* Get the source block and the file block, without reading
+       * anything that is known to be zero */
+      if (holeCheck(&hs, p, blen)) {
+        memset(pSrc, 0, (size_t) blen);
+      } else {
+        readBlock(ps, p, pSrc, blen);
+        cacheDrop(&cs, p, blen);
+      }
+      
+      if ((p >= dlen) || holeCheck(&hd, p, blen)) {
+        memset(pDst, 0, (size_t) blen);
+      } else if (dlen - p < blen) {
+        readBlock(pv, p, pDst, (int32_t) (dlen - p));
+        memset(pDst + (dlen - p), 0, (size_t) (blen - (dlen - p)));
+      } else {
+        readBlock(pv, p, pDst, blen);
+      }
+      
+      /* Skip each run of pages that are the same and write each run of
+       * pages that differ */
+      for(i = 0; i < blen; i = j) {
+        i = mirrorSpan(pSrc, pDst, i, blen, 1);
+        j = mirrorSpan(pSrc, pDst, i, blen, 0);
+        if (j > i) {
+          writeBlock(pv, p + i, pSrc + i, j - i);
+          written += (j - i);
         }
       }
-    
-      /* Print the listing line */
-      printListLine(&ls);
+      cacheDrop(&cd, p, blen);
     }
   }
   
-  /* Close viewer if open */
+  /* Report the counts */
+  if (status) {
+    printf("Bytes compared: ");
+    printInt64(slen);
+    printf("\n");
+    printf("Bytes written: ");
+    printInt64(written);
+    printf("\n");
+  }
+  
+  /* Release buffers and locks, and close viewers, cache droppers, and
+   * hole maps if open */
+  bufFree(pSrc);
+  bufFree(pDst);
   aksview_close(pv);
+  aksview_close(ps);
+  cacheClose(&cd);
+  cacheClose(&cs);
+  holeClose(&hd);
+  holeClose(&hs);
+  lockRelease(&lk);
+  lockRelease(&ls);
   
   /* Return status */
   return status;
 }
 
 /*
- * @@TODO:
- */
-static int verb_read(
-    const char *pPath,
-    const char *pAt,
-    const char *pAs) {
-  fprintf(stderr, "verb_read %s at %s as %s\n", pPath, pAt, pAs);
-  return 1;
-}
-
-/*
- * @@TODO:
- */
-static int verb_write(
-    const char *pPath,
-    const char *pAt,
-    const char *pAs,
-    const char *pWith) {
-  fprintf(stderr, "verb_write %s at %s as %s with %s\n",
-    pPath, pAt, pAs, pWith);
-  return 1;
-}
-
-/*
- * Verb to report the file size of an existing file.
+ * Verb to open an edit session for a file.
+ * 
+ * The session starts with a single piece covering the whole original
+ * file and an empty add-buffer.
  * 
  * Parameters:
  * 
@@ -641,95 +11061,178 @@ static int verb_write(
  * 
  *   non-zero if successful, zero if error
  */
-static int verb_query(const char *pPath) {
+static int verb_begin(const char *pPath) {
   
   int status = 1;
   int errcode = 0;
-  int64_t fl = 0;
-  AKSVIEW *pv = NULL;
+  AKSVIEW *ps = NULL;
+  char *pSPath = NULL;
+  
+  EDIT_SESSION es;
+  
+  /* Initialize structures */
+  memset(&es, 0, sizeof(EDIT_SESSION));
   
   /* Check parameter */
   if (pPath == NULL) {
     fault(__LINE__);
   }
   
-  /* Open a read-only view */
-  pv = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
-  if (pv == NULL) {
+  /* Open a read-only view of the original file to get its length */
+  es.pv = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
+  if (es.pv == NULL) {
     status = 0;
     fprintf(stderr, "%s: Failed to open file: %s\n",
               pModule, aksview_errstr(errcode));
   }
   
-  /* Print the file length */
+  /* Open the session file, creating it if necessary, and make sure
+   * there is not already a session open */
   if (status) {
-    printf("File length: ");
-    printInt64(aksview_getlen(pv));
-    printf("\n");
+    pSPath = sidecarPath(pPath, SESSION_SUFFIX);
+    ps = aksview_create(pSPath, AKSVIEW_REGULAR, &errcode);
+    if (ps == NULL) {
+      status = 0;
+      fprintf(stderr, "%s: Failed to open edit session: %s\n",
+                pModule, aksview_errstr(errcode));
+    }
   }
   
-  /* Close viewer if open */
-  aksview_close(pv);
+  if (status && (aksview_getlen(ps) > 0)) {
+    status = 0;
+    fprintf(stderr, "%s: An edit session is already open for file!\n",
+              pModule);
+  }
+  
+  aksview_close(ps);
+  ps = NULL;
+  
+  /* Build the initial piece table and save it */
+  if (status) {
+    es.orig_len = aksview_getlen(es.pv);
+    if (es.orig_len > 0) {
+      if (!sessionAddPiece(&es, 0, PIECE_ORIG, 0, es.orig_len)) {
+        fault(__LINE__);
+      }
+    }
+    es.len = es.orig_len;
+    status = sessionSave(&es, pPath);
+  }
+  
+  /* Release session and path */
+  sessionFree(&es);
+  free(pSPath);
   
   /* Return status */
   return status;
 }
 
 /*
- * Verb to resize an existing file.
+ * Verb to write all the edits of the open edit session into the file
+ * and close the session.
  * 
  * Parameters:
  * 
  *   pPath - the path to the file
  * 
- *   pWith - string parameter containing the new length
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
  */
-static int verb_resize(const char *pPath, const char *pWith) {
+static int verb_commit(const char *pPath) {
   
   int status = 1;
-  int errcode = 0;
-  int64_t fl = 0;
-  AKSVIEW *pv = NULL;
+  uint8_t *pBuf = NULL;
   
-  /* Check parameters */
-  if ((pPath == NULL) || (pWith == NULL)) {
+  EDIT_SESSION es;
+  RANGE_LOCK lk;
+  
+  /* Initialize structures */
+  memset(&es, 0, sizeof(EDIT_SESSION));
+  lk.fd = -1;
+  
+  /* Check parameter */
+  if (pPath == NULL) {
     fault(__LINE__);
   }
   
-  /* Parse the desired new file length */
-  fl = parseCount(pWith);
-  if (fl < 0) {
-    status = 0;
-    fprintf(stderr, "%s: Failed to parse count: %s\n",
-              pModule, pWith);
+  /* Load the session with a writable view of the file, and lock the
+   * whole file for writing, since the edits may move any of it */
+  status = sessionLoad(&es, pPath, AKSVIEW_EXISTING);
+  if (status) {
+    status = lockRange(&lk, pPath, 0, LOCK_TO_END, 1, 0);
   }
   
-  /* Make sure file length doesn't exceed aksview limit */
-  if (status && (fl > AKSVIEW_MAXLEN)) {
-    status = 0;
-    fprintf(stderr, "%s: Length exceeded AKSVIEW_MAXLEN!\n", pModule);
+  /* Write the edits */
+  if (status) {
+    pBuf = (uint8_t *) bufAlloc(BLOCK_SIZE);
+    if (pBuf != NULL) {
+      status = sessionCommit(&es, pBuf);
+    } else {
+      status = 0;
+    }
+  }
+  
+  /* Release session and locks, closing the file */
+  sessionFree(&es);
+  bufFree(pBuf);
+  lockRelease(&lk);
+  
+  /* Close the session */
+  if (status) {
+    status = verb_abort(pPath);
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Verb to discard all the edits of the open edit session and close the
+ * session.
+ * 
+ * The original file is not accessed at all.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int verb_abort(const char *pPath) {
+  
+  int status = 1;
+  int errcode = 0;
+  AKSVIEW *ps = NULL;
+  char *pSPath = NULL;
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
   }
   
-  /* Open a read-write view */
-  if (status) {
-    pv = aksview_create(pPath, AKSVIEW_EXISTING, &errcode);
-    if (pv == NULL) {
-      status = 0;
-      fprintf(stderr, "%s: Failed to open file: %s\n",
-                pModule, aksview_errstr(errcode));
-    }
+  /* Open the session file */
+  pSPath = sidecarPath(pPath, SESSION_SUFFIX);
+  ps = aksview_create(pSPath, AKSVIEW_EXISTING, &errcode);
+  if (ps == NULL) {
+    status = 0;
+    fprintf(stderr, "%s: Failed to open edit session: %s\n",
+              pModule, aksview_errstr(errcode));
   }
   
-  /* Set the file length */
+  /* Empty the session file */
   if (status) {
-    if (!aksview_setlen(pv, fl)) {
+    if (!aksview_setlen(ps, 0)) {
       status = 0;
-      fprintf(stderr, "%s: Failed to set length on file!\n", pModule);
+      fprintf(stderr, "%s: Failed to close edit session!\n", pModule);
     }
   }
   
-  /* Close viewer if open */
-  aksview_close(pv);
+  /* Close session file and release path */
+  aksview_close(ps);
+  free(pSPath);
   
   /* Return status */
   return status;
@@ -824,6 +11327,9 @@ static int maint(int argc, char *argv[]) {
   
   int status = 1;
   int x = 0;
+  int pathc = 1;
+  int stats = 0;
+  int64_t cap = 0;
   
   const char *pVerb = NULL;
   const char *pPath = NULL;
@@ -832,6 +11338,8 @@ static int maint(int argc, char *argv[]) {
   const char *pAt   = NULL;
   const char *pAs   = NULL;
   const char *pWith = NULL;
+  const char *pIn   = NULL;
+  const char *pTo   = NULL;
   
   /* Get the module name */
   pModule = NULL;
@@ -842,6 +11350,12 @@ static int maint(int argc, char *argv[]) {
     pModule = "binpoke";
   }
   
+  /* Look up the type of sidecar integer fields */
+  pSidecarType = binpoke_parsetype("u64le");
+  if (pSidecarType == NULL) {
+    fault(__LINE__);
+  }
+  
   /* Make sure arguments are present */
   if (argc > 0) {
     if (argv == NULL) {
@@ -854,21 +11368,80 @@ static int maint(int argc, char *argv[]) {
     }
   }
   
-  /* If nothing beyond the module name is passed, just print the
-   * invocation syntax summary and fail */
-  if (argc < 2) {
+  /* Handle any options before the verb, which begin with "--" */
+  for(x = 1; status && (x < argc) && (strncmp(argv[x], "--", 2) == 0);
+        x++) {
+    if (strcmp(argv[x], "--stats") == 0) {
+      stats = 1;
+      
+    } else if ((strcmp(argv[x], "--max-memory") == 0) &&
+                (x + 1 < argc)) {
+      x++;
+      cap = binpoke_parsecount(argv[x]);
+      if (bufPool.cap >= 0) {
+        status = 0;
+        fprintf(stderr, "%s: Option used more than once: %s\n",
+                  pModule, argv[x - 1]);
+      } else if (cap < 0) {
+        status = 0;
+        fprintf(stderr, "%s: Invalid memory budget: %s\n",
+                  pModule, argv[x]);
+      } else {
+        status = poolInit(cap);
+      }
+      
+    } else {
+      status = 0;
+      fprintf(stderr, "%s: Unrecognized option: %s\n", pModule, argv[x]);
+    }
+  }
+  
+  /* Remove the options, so that the module name is followed by the
+   * verb */
+  if (status && (x > 1)) {
+    argv[x - 1] = argv[0];
+    argv += x - 1;
+    argc -= x - 1;
+  }
+  
+  /* If nothing beyond the module name and options is passed, just
+   * print the invocation syntax summary and fail */
+  if (status && (argc < 2)) {
     status = 0;
     fprintf(stderr,
       "binpoke syntax summary:\n"
       "\n"
-      "binpoke list [path] from [addr] for [count]\n"
-      "binpoke read [path] at [addr] as [type]\n"
-      "binpoke write [path] at [addr] as [type] with [value]\n"
-      "binpoke query [path]\n"
-      "binpoke resize [path] with [count]\n"
+      "binpoke list [path] from [addr] for [count] (in [mode])\n"
+      "binpoke read [path] at [addr] as [type] (in [mode])\n"
+      "binpoke write [path] at [addr] as [type] with [value] (in [mode])\n"
+      "binpoke query [path] ([path] ...) (in [mode])\n"
+      "binpoke resize [path] with [count] (in [mode])\n"
+      "binpoke batch [path] with [script] (in [mode])\n"
+      "binpoke recover [path]\n"
+      "binpoke swap [path] from [addr] for [count] as [width] (in [mode])\n"
+      "binpoke insert [path] at [addr] for [count] (in [mode])\n"
+      "binpoke remove [path] from [addr] for [count] (in [mode])\n"
+      "binpoke import [path] with [listing] (at [addr]) (in [mode])\n"
+      "binpoke xform [path] from [addr] for [count] with [key]"
+        " (as [type]) (in [mode]) (to [target])\n"
+      "binpoke walk [path] at [addr] as [layout] (for [count]) (in [mode])\n"
+      "binpoke chunk [path] at [index]\n"
+      "binpoke strings [path] from [addr] for [count] (with [minimum])"
+        " (in [mode])\n"
+      "binpoke manifest [path] (with [blocksize]) (in [mode])\n"
+      "binpoke changed [path] (in [mode])\n"
+      "binpoke mirror [path] with [srcpath] (in [mode])\n"
+      "binpoke begin [path]\n"
+      "binpoke commit [path]\n"
+      "binpoke abort [path]\n"
       "binpoke require [path]\n"
       "binpoke new [path]\n"
       "\n"
+      "Options may come before the verb:\n"
+      "\n"
+      "--max-memory [count]\n"
+      "--stats\n"
+      "\n"
       "See the README for further documentation.\n");
   }
   
@@ -879,9 +11452,17 @@ static int maint(int argc, char *argv[]) {
     fprintf(stderr, "%s: Invalid invocation syntax!\n", pModule);
   }
   
-  /* Must have an odd number of total arguments, since we have the
-   * module name and then pairs of arguments after that */
-  if (status && ((argc & 0x1) == 0)) {
+  /* The query verb may be given further paths after the first one, up
+   * to the first preposition */
+  if (status && (strcmp(argv[1], "query") == 0)) {
+    while ((2 + pathc < argc) && (!isPreposition(argv[2 + pathc]))) {
+      pathc++;
+    }
+  }
+  
+  /* Must have an even number of arguments after the paths, since they
+   * are pairs of arguments */
+  if (status && (((argc - 2 - pathc) & 0x1) != 0)) {
     status = 0;
     fprintf(stderr, "%s: Invalid invocation syntax!\n", pModule);
   }
@@ -892,12 +11473,12 @@ static int maint(int argc, char *argv[]) {
     pPath = argv[2];
   }
   
-  /* For any arguments beyond the verb and file path, parse them as
+  /* For any arguments beyond the verb and file paths, parse them as
    * phrases consisting of a preposition followed by a nominal; we
-   * already checked earlier that the total number of arguments is odd
-   * so we can step through extra arguments in pairs */
+   * already checked earlier that the number of these arguments is even
+   * so we can step through them in pairs */
   if (status) {
-    for(x = 3; x < argc; x += 2) {
+    for(x = 2 + pathc; x < argc; x += 2) {
       /* Handle each preposition, storing value in appropriate variable
        * and making sure the preposition hasn't been used before */
       if (strcmp(argv[x], "from") == 0) {
@@ -945,6 +11526,24 @@ static int maint(int argc, char *argv[]) {
                     pModule, argv[x]);
         }
         
+      } else if (strcmp(argv[x], "in") == 0) {
+        if (pIn == NULL) {
+          pIn = argv[x + 1];
+        } else {
+          status = 0;
+          fprintf(stderr, "%s: Preposition used more than once: %s\n",
+                    pModule, argv[x]);
+        }
+        
+      } else if (strcmp(argv[x], "to") == 0) {
+        if (pTo == NULL) {
+          pTo = argv[x + 1];
+        } else {
+          status = 0;
+          fprintf(stderr, "%s: Preposition used more than once: %s\n",
+                    pModule, argv[x]);
+        }
+        
       } else {
         status = 0;
         fprintf(stderr, "%s: Unrecognized preposition: %s\n",
@@ -966,8 +11565,9 @@ static int maint(int argc, char *argv[]) {
           (pFor  != NULL) &&
           (pAt   == NULL) &&
           (pAs   == NULL) &&
-          (pWith == NULL)) {
-        if (!verb_list(pPath, pFrom, pFor)) {
+          (pWith == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_list(pPath, pFrom, pFor, pIn)) {
           status = 0;
         }
         
@@ -982,8 +11582,9 @@ static int maint(int argc, char *argv[]) {
           (pFor  == NULL) &&
           (pAt   != NULL) &&
           (pAs   != NULL) &&
-          (pWith == NULL)) {
-        if (!verb_read(pPath, pAt, pAs)) {
+          (pWith == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_read(pPath, pAt, pAs, pIn)) {
           status = 0;
         }
         
@@ -998,8 +11599,9 @@ static int maint(int argc, char *argv[]) {
           (pFor  == NULL) &&
           (pAt   != NULL) &&
           (pAs   != NULL) &&
-          (pWith != NULL)) {
-        if (!verb_write(pPath, pAt, pAs, pWith)) {
+          (pWith != NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_write(pPath, pAt, pAs, pWith, pIn)) {
           status = 0;
         }
         
@@ -1014,8 +11616,9 @@ static int maint(int argc, char *argv[]) {
           (pFor  == NULL) &&
           (pAt   == NULL) &&
           (pAs   == NULL) &&
-          (pWith == NULL)) {
-        if (!verb_query(pPath)) {
+          (pWith == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_query(argv + 2, pathc, pIn)) {
           status = 0;
         }
         
@@ -1030,8 +11633,280 @@ static int maint(int argc, char *argv[]) {
           (pFor  == NULL) &&
           (pAt   == NULL) &&
           (pAs   == NULL) &&
+          (pWith != NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_resize(pPath, pWith, pIn)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "batch") == 0) {
+      if ((pFrom == NULL) &&
+          (pFor  == NULL) &&
+          (pAt   == NULL) &&
+          (pAs   == NULL) &&
+          (pWith != NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_batch(pPath, pWith, pIn)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "recover") == 0) {
+      if ((pFrom == NULL) &&
+          (pFor  == NULL) &&
+          (pAt   == NULL) &&
+          (pAs   == NULL) &&
+          (pWith == NULL) &&
+          (pIn   == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_recover(pPath)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "swap") == 0) {
+      if ((pFrom != NULL) &&
+          (pFor  != NULL) &&
+          (pAt   == NULL) &&
+          (pAs   != NULL) &&
+          (pWith == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_swap(pPath, pFrom, pFor, pAs, pIn)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "insert") == 0) {
+      if ((pFrom == NULL) &&
+          (pFor  != NULL) &&
+          (pAt   != NULL) &&
+          (pAs   == NULL) &&
+          (pWith == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_insert(pPath, pAt, pFor, pIn)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "remove") == 0) {
+      if ((pFrom != NULL) &&
+          (pFor  != NULL) &&
+          (pAt   == NULL) &&
+          (pAs   == NULL) &&
+          (pWith == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_remove(pPath, pFrom, pFor, pIn)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "import") == 0) {
+      if ((pFrom == NULL) &&
+          (pFor  == NULL) &&
+          (pAs   == NULL) &&
+          (pWith != NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_import(pPath, pWith, pAt, pIn)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "xform") == 0) {
+      if ((pFrom != NULL) &&
+          (pFor  != NULL) &&
+          (pAt   == NULL) &&
           (pWith != NULL)) {
-        if (!verb_resize(pPath, pWith)) {
+        if (!verb_xform(pPath, pFrom, pFor, pWith, pAs, pIn, pTo)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "walk") == 0) {
+      if ((pFrom == NULL) &&
+          (pAt   != NULL) &&
+          (pAs   != NULL) &&
+          (pWith == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_walk(pPath, pAt, pAs, pFor, pIn)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "chunk") == 0) {
+      if ((pFrom == NULL) &&
+          (pFor  == NULL) &&
+          (pAt   != NULL) &&
+          (pAs   == NULL) &&
+          (pWith == NULL) &&
+          (pIn   == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_chunk(pPath, pAt)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "strings") == 0) {
+      if ((pFrom != NULL) &&
+          (pFor  != NULL) &&
+          (pAt   == NULL) &&
+          (pAs   == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_strings(pPath, pFrom, pFor, pWith, pIn)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "manifest") == 0) {
+      if ((pFrom == NULL) &&
+          (pFor  == NULL) &&
+          (pAt   == NULL) &&
+          (pAs   == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_manifest(pPath, pWith, pIn)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "changed") == 0) {
+      if ((pFrom == NULL) &&
+          (pFor  == NULL) &&
+          (pAt   == NULL) &&
+          (pAs   == NULL) &&
+          (pWith == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_changed(pPath, pIn)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "mirror") == 0) {
+      if ((pFrom == NULL) &&
+          (pFor  == NULL) &&
+          (pAt   == NULL) &&
+          (pAs   == NULL) &&
+          (pWith != NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_mirror(pPath, pWith, pIn)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "begin") == 0) {
+      if ((pFrom == NULL) &&
+          (pFor  == NULL) &&
+          (pAt   == NULL) &&
+          (pAs   == NULL) &&
+          (pWith == NULL) &&
+          (pIn   == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_begin(pPath)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "commit") == 0) {
+      if ((pFrom == NULL) &&
+          (pFor  == NULL) &&
+          (pAt   == NULL) &&
+          (pAs   == NULL) &&
+          (pWith == NULL) &&
+          (pIn   == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_commit(pPath)) {
+          status = 0;
+        }
+        
+      } else {
+        status = 0;
+        fprintf(stderr, "%s: Wrong prepositional phrases for verb %s\n",
+                  pModule, pVerb);
+      }
+      
+    } else if (strcmp(pVerb, "abort") == 0) {
+      if ((pFrom == NULL) &&
+          (pFor  == NULL) &&
+          (pAt   == NULL) &&
+          (pAs   == NULL) &&
+          (pWith == NULL) &&
+          (pIn   == NULL) &&
+          (pTo   == NULL)) {
+        if (!verb_abort(pPath)) {
           status = 0;
         }
         
@@ -1046,7 +11921,9 @@ static int maint(int argc, char *argv[]) {
           (pFor  == NULL) &&
           (pAt   == NULL) &&
           (pAs   == NULL) &&
-          (pWith == NULL)) {
+          (pWith == NULL) &&
+          (pIn   == NULL) &&
+          (pTo   == NULL)) {
         if (!verb_require(pPath)) {
           status = 0;
         }
@@ -1062,7 +11939,9 @@ static int maint(int argc, char *argv[]) {
           (pFor  == NULL) &&
           (pAt   == NULL) &&
           (pAs   == NULL) &&
-          (pWith == NULL)) {
+          (pWith == NULL) &&
+          (pIn   == NULL) &&
+          (pTo   == NULL)) {
         if (!verb_new(pPath)) {
           status = 0;
         }
@@ -1079,6 +11958,13 @@ static int maint(int argc, char *argv[]) {
     }
   }
   
+  /* Print the buffer pool statistics if requested, and release the
+   * pool */
+  if (stats) {
+    poolStats();
+  }
+  poolRelease();
+  
   /* Determine return code and return */
   if (status) {
     status = EXIT_SUCCESS;
@@ -0,0 +1,1541 @@
+/*
+ * libbinpoke.c
+ * ============
+ * 
+ * Implementation of libbinpoke.h
+ * 
+ * See the header for the specification of the public functions.
+ */
+
+/* Make stat() visible even in a strict ISO C build; this must come
+ * before any header */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE) && \
+    !defined(_XOPEN_SOURCE) && !defined(_GNU_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "aksmacro.h"
+
+#include "libbinpoke.h"
+
+#include "aksview.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef AKS_WIN
+#include <errno.h>
+#include <sys/stat.h>
+#endif
+
+/*
+ * Constants
+ * =========
+ */
+
+/*
+ * The number of supported integer types, not counting the entry at the
+ * end of the type table.
+ */
+#define TYPE_COUNT (14)
+
+/*
+ * Type declarations
+ * =================
+ */
+
+/*
+ * BINPOKE structure, which is declared opaquely in the header.
+ */
+struct BINPOKE_TAG {
+  
+  /*
+   * The view of the file.
+   */
+  AKSVIEW *pv;
+  
+  /*
+   * Non-zero if the handle was opened with BINPOKE_READWRITE or
+   * BINPOKE_CREATE.
+   */
+  int writable;
+  
+};
+
+/*
+ * Static data
+ * ===========
+ */
+
+/*
+ * The table of all supported integer types.
+ * 
+ * The table ends with an entry that has a NULL name.
+ */
+static const BINPOKE_TYPE typeTable[TYPE_COUNT + 1] = {
+  {"u8"   , 0, 1, 0},
+  {"s8"   , 1, 1, 0},
+  {"u16le", 0, 2, 0},
+  {"u16be", 0, 2, 1},
+  {"s16le", 1, 2, 0},
+  {"s16be", 1, 2, 1},
+  {"u32le", 0, 4, 0},
+  {"u32be", 0, 4, 1},
+  {"s32le", 1, 4, 0},
+  {"s32be", 1, 4, 1},
+  {"u64le", 0, 8, 0},
+  {"u64be", 0, 8, 1},
+  {"s64le", 1, 8, 0},
+  {"s64be", 1, 8, 1},
+  {NULL   , 0, 0, 0}
+};
+
+/*
+ * The base-16 digits used in listing lines.
+ */
+static const char hexDigits[] = "0123456789abcdef";
+
+/*
+ * Local functions
+ * ===============
+ */
+
+/* Prototypes */
+static void fault(int line);
+static int parseDecimal(const char *pstr, uint64_t *pv);
+static int inRange(BINPOKE *pb, int64_t addr, int64_t len);
+static void setError(int *perr, int code);
+static int openError(const char *pPath);
+
+/*
+ * Invoked when there is an unexpected error condition within this
+ * source file.
+ * 
+ * Only the local functions fault, since the public functions check
+ * their parameters and report BINPOKE_ERR_PARAM before calling them.
+ * 
+ * Prints a diagnostic message to stderr and then exits program with
+ * failure code.
+ * 
+ * Parameters:
+ * 
+ *   line - the line number of the fault in this source file
+ * 
+ * Return:
+ * 
+ *   this function never returns
+ */
+static void fault(int line) {
+  fprintf(stderr, "Fault in libbinpoke at line %d\n", line);
+  exit(EXIT_FAILURE);
+}
+
+/*
+ * Parse a sequence of decimal digits as an unsigned value.
+ * 
+ * pstr must point to a sequence of at least one decimal digit.
+ * 
+ * The result will be stored in *pv.  If parsing fails, an undefined
+ * value will be in *pv.  Check the return to determine whether parsing
+ * succeeded or not.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ *   pv - pointer to variable to receive parsed result
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+static int parseDecimal(const char *pstr, uint64_t *pv) {
+  
+  int status = 1;
+  int d = 0;
+  
+  /* Check parameters */
+  if ((pstr == NULL) || (pv == NULL)) {
+    fault(__LINE__);
+  }
+  
+  /* Reset result to zero */
+  *pv = 0;
+  
+  /* Fail if empty string */
+  if (*pstr == 0) {
+    status = 0;
+  }
+  
+  /* Parse all digits */
+  if (status) {
+    for( ; *pstr != 0; pstr++) {
+      /* Get current digit value */
+      if ((*pstr >= '0') && (*pstr <= '9')) {
+        d = *pstr - '0';
+      } else {
+        status = 0;
+      }
+      
+      /* Multiply result by 10, watching for overflow */
+      if (status) {
+        if (*pv <= UINT64_MAX / 10) {
+          *pv *= 10;
+        } else {
+          status = 0;
+        }
+      }
+      
+      /* Add digit into result, watching for overflow */
+      if (status) {
+        if (*pv <= UINT64_MAX - d) {
+          *pv += d;
+        } else {
+          status = 0;
+        }
+      }
+      
+      /* Leave loop if error */
+      if (!status) {
+        break;
+      }
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Check that a byte range is within the file limits of a handle.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle
+ * 
+ *   addr - the file offset of the first byte
+ * 
+ *   len - the number of bytes
+ * 
+ * Return:
+ * 
+ *   non-zero if within the file limits, zero if not
+ */
+static int inRange(BINPOKE *pb, int64_t addr, int64_t len) {
+  
+  int result = 1;
+  
+  /* Check parameters */
+  if ((pb == NULL) || (len < 0)) {
+    fault(__LINE__);
+  }
+  
+  /* Check the range */
+  if ((addr < 0) || (addr > aksview_getlen(pb->pv)) ||
+      (len > aksview_getlen(pb->pv) - addr)) {
+    result = 0;
+  }
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Report an error code.
+ * 
+ * Parameters:
+ * 
+ *   perr - the variable to receive the error code, or NULL
+ * 
+ *   code - the error code
+ */
+static void setError(int *perr, int code) {
+  if (perr != NULL) {
+    *perr = code;
+  }
+}
+
+/*
+ * Find the error code for a file that could not be opened.
+ * 
+ * On POSIX platforms, the status of the path tells a missing file and a
+ * directory apart from other failures.  On Windows, the error is always
+ * BINPOKE_ERR_OPEN.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ * Return:
+ * 
+ *   the error code
+ */
+static int openError(const char *pPath) {
+  
+  int result = BINPOKE_ERR_OPEN;
+#ifndef AKS_WIN
+  struct stat st;
+#endif
+  
+  /* Check parameter */
+  if (pPath == NULL) {
+    fault(__LINE__);
+  }
+  
+  /* Look at the status of the path */
+#ifndef AKS_WIN
+  if (stat(pPath, &st) != 0) {
+    if ((errno == ENOENT) || (errno == ENOTDIR)) {
+      result = BINPOKE_ERR_NOTFOUND;
+    }
+  } else if (S_ISDIR(st.st_mode)) {
+    result = BINPOKE_ERR_ISDIR;
+  }
+#endif
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Public functions
+ * ================
+ */
+
+/*
+ * Open a handle to a file.
+ * 
+ * The libaksview error code of a failed open is not passed on, since
+ * its values belong to libaksview.  openError() finds the code instead.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   mode - BINPOKE_READONLY, BINPOKE_READWRITE, or BINPOKE_CREATE
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   the new handle, or NULL if error
+ */
+BINPOKE *binpoke_open(const char *pPath, int mode, int *perr) {
+  
+  int status = 1;
+  int errcode = 0;
+  AKSVIEW *pv = NULL;
+  BINPOKE *pb = NULL;
+  
+  /* Check parameters */
+  if ((pPath == NULL) || ((mode != BINPOKE_READONLY) &&
+        (mode != BINPOKE_READWRITE) && (mode != BINPOKE_CREATE))) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_PARAM);
+  }
+  
+  /* Open the view */
+  if (status) {
+    if (mode == BINPOKE_CREATE) {
+      pv = aksview_create(pPath, AKSVIEW_REGULAR, &errcode);
+    } else if (mode == BINPOKE_READWRITE) {
+      pv = aksview_create(pPath, AKSVIEW_EXISTING, &errcode);
+    } else {
+      pv = aksview_create(pPath, AKSVIEW_READONLY, &errcode);
+    }
+    if (pv == NULL) {
+      status = 0;
+      setError(perr, openError(pPath));
+    }
+  }
+  
+  /* Allocate the handle */
+  if (status) {
+    pb = (BINPOKE *) malloc(sizeof(BINPOKE));
+    if (pb == NULL) {
+      status = 0;
+      setError(perr, BINPOKE_ERR_NOMEM);
+      aksview_close(pv);
+      pv = NULL;
+    }
+  }
+  if (status) {
+    memset(pb, 0, sizeof(BINPOKE));
+    pb->pv = pv;
+    pb->writable = (mode != BINPOKE_READONLY);
+  }
+  
+  /* Return the handle or NULL */
+  return pb;
+}
+
+/*
+ * Close a handle.
+ * 
+ * Any changes are written back to the file.  Does nothing if NULL is
+ * passed.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle to close, or NULL
+ */
+void binpoke_close(BINPOKE *pb) {
+  if (pb != NULL) {
+    aksview_close(pb->pv);
+    free(pb);
+  }
+}
+
+/*
+ * Get the message for an error code.
+ * 
+ * Parameters:
+ * 
+ *   code - the error code
+ * 
+ * Return:
+ * 
+ *   the error message, which has no line break
+ */
+const char *binpoke_errstr(int code) {
+  
+  const char *pResult = NULL;
+  
+  switch (code) {
+    case BINPOKE_ERR_NONE:
+      pResult = "No error";
+      break;
+    
+    case BINPOKE_ERR_RANGE:
+      pResult = "Byte range is outside file limits";
+      break;
+    
+    case BINPOKE_ERR_READONLY:
+      pResult = "File was opened read-only";
+      break;
+    
+    case BINPOKE_ERR_MAXLEN:
+      pResult = "Length exceeded AKSVIEW_MAXLEN";
+      break;
+    
+    case BINPOKE_ERR_SETLEN:
+      pResult = "Failed to set length on file";
+      break;
+    
+    case BINPOKE_ERR_OPEN:
+      pResult = "Failed to open file";
+      break;
+    
+    case BINPOKE_ERR_NOTFOUND:
+      pResult = "No such file or directory";
+      break;
+    
+    case BINPOKE_ERR_ISDIR:
+      pResult = "Is a directory";
+      break;
+    
+    case BINPOKE_ERR_PARAM:
+      pResult = "Invalid parameter";
+      break;
+    
+    case BINPOKE_ERR_NOMEM:
+      pResult = "Out of memory";
+      break;
+    
+    default:
+      pResult = "Unknown error";
+  }
+  
+  return pResult;
+}
+
+/*
+ * Get the current length of the file of a handle.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle
+ * 
+ * Return:
+ * 
+ *   the file length in bytes, or -1 if pb is NULL
+ */
+int64_t binpoke_getlen(BINPOKE *pb) {
+  
+  int64_t result = -1;
+  
+  /* Get the length if there is a handle */
+  if (pb != NULL) {
+    result = aksview_getlen(pb->pv);
+  }
+  
+  /* Return result */
+  return result;
+}
+
+/*
+ * Change the length of the file of a handle.
+ * 
+ * Bytes added at the end of the file are zero.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle, which must be opened with BINPOKE_READWRITE
+ * 
+ *   len - the new length in bytes
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_setlen(BINPOKE *pb, int64_t len, int *perr) {
+  
+  int status = 1;
+  
+  /* Check parameters */
+  if ((pb == NULL) || (len < 0)) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_PARAM);
+  }
+  
+  /* Check the handle mode and the length limit */
+  if (status && (!(pb->writable))) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_READONLY);
+  }
+  
+  if (status && (len > AKSVIEW_MAXLEN)) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_MAXLEN);
+  }
+  
+  /* Set the length */
+  if (status) {
+    if (!aksview_setlen(pb->pv, len)) {
+      status = 0;
+      setError(perr, BINPOKE_ERR_SETLEN);
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Read an integer from the file of a handle.
+ * 
+ * The bits of the integer are returned without sign extension.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle
+ * 
+ *   addr - the file offset of the first byte of the integer
+ * 
+ *   pt - the integer type
+ * 
+ *   pv - receives the bits of the integer
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_read(
+    BINPOKE *pb,
+    int64_t addr,
+    const BINPOKE_TYPE *pt,
+    uint64_t *pv,
+    int *perr) {
+  
+  int status = 1;
+  uint8_t buf[8];
+  
+  /* Check parameters */
+  if ((pb == NULL) || (pt == NULL) || (pv == NULL)) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_PARAM);
+  }
+  
+  /* Read and decode the bytes */
+  if (status) {
+    status = binpoke_readbytes(pb, addr, buf, pt->width, perr);
+  }
+  if (status) {
+    *pv = binpoke_decode(buf, pt);
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Write an integer into the file of a handle.
+ * 
+ * Bits beyond the width of the type are ignored.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle, which must be opened with BINPOKE_READWRITE
+ * 
+ *   addr - the file offset of the first byte of the integer
+ * 
+ *   pt - the integer type
+ * 
+ *   v - the bits of the integer
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_write(
+    BINPOKE *pb,
+    int64_t addr,
+    const BINPOKE_TYPE *pt,
+    uint64_t v,
+    int *perr) {
+  
+  int status = 1;
+  uint8_t buf[8];
+  
+  /* Check parameters */
+  if ((pb == NULL) || (pt == NULL)) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_PARAM);
+  }
+  
+  /* Encode and write the bytes */
+  if (status) {
+    binpoke_encode(buf, pt, v);
+    status = binpoke_writebytes(pb, addr, buf, pt->width, perr);
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Read a range of bytes from the file of a handle.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle
+ * 
+ *   addr - the file offset of the first byte
+ * 
+ *   pBuf - receives the bytes
+ * 
+ *   len - the number of bytes to read, which may be zero
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_readbytes(
+    BINPOKE *pb,
+    int64_t addr,
+    uint8_t *pBuf,
+    int32_t len,
+    int *perr) {
+  
+  int status = 1;
+  int32_t i = 0;
+  
+  /* Check parameters */
+  if ((pb == NULL) || (pBuf == NULL) || (len < 0)) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_PARAM);
+  }
+  
+  /* Check the file limits */
+  if (status && (!inRange(pb, addr, len))) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_RANGE);
+  }
+  
+  /* Read each byte */
+  if (status) {
+    for(i = 0; i < len; i++) {
+      pBuf[i] = (uint8_t) aksview_read8u(pb->pv, addr + ((int64_t) i));
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Write a range of bytes into the file of a handle.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle, which must be opened with BINPOKE_READWRITE or
+ *   BINPOKE_CREATE
+ * 
+ *   addr - the file offset of the first byte
+ * 
+ *   pBuf - the bytes to write
+ * 
+ *   len - the number of bytes to write, which may be zero
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_writebytes(
+    BINPOKE *pb,
+    int64_t addr,
+    const uint8_t *pBuf,
+    int32_t len,
+    int *perr) {
+  
+  int status = 1;
+  int32_t i = 0;
+  
+  /* Check parameters */
+  if ((pb == NULL) || (pBuf == NULL) || (len < 0)) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_PARAM);
+  }
+  
+  /* Check the handle mode and the file limits */
+  if (status && (!(pb->writable))) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_READONLY);
+  }
+  
+  if (status && (!inRange(pb, addr, len))) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_RANGE);
+  }
+  
+  /* Write each byte */
+  if (status) {
+    for(i = 0; i < len; i++) {
+      aksview_write8(pb->pv, addr + ((int64_t) i), pBuf[i]);
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Read a batch of integers from the file of a handle.
+ * 
+ * Every operation is checked against the file limits before anything
+ * is read.  The value of each operation is then filled in.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle
+ * 
+ *   pOps - the operations
+ * 
+ *   count - the number of operations, which may be zero
+ * 
+ *   pFail - receives the index of the operation that failed if error,
+ *   or NULL
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_readbatch(
+    BINPOKE *pb,
+    BINPOKE_OP *pOps,
+    int64_t count,
+    int64_t *pFail,
+    int *perr) {
+  
+  int status = 1;
+  int64_t x = 0;
+  
+  /* Check parameters */
+  if ((pb == NULL) || ((pOps == NULL) && (count > 0)) || (count < 0)) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_PARAM);
+  }
+  
+  /* Check that every operation is within the file limits */
+  for(x = 0; status && (x < count); x++) {
+    if (pOps[x].pt == NULL) {
+      status = 0;
+      setError(perr, BINPOKE_ERR_PARAM);
+    } else if (!inRange(pb, pOps[x].addr, pOps[x].pt->width)) {
+      status = 0;
+      setError(perr, BINPOKE_ERR_RANGE);
+    }
+    if ((!status) && (pFail != NULL)) {
+      *pFail = x;
+    }
+  }
+  
+  /* Read every value */
+  if (status) {
+    for(x = 0; x < count; x++) {
+      binpoke_read(pb, pOps[x].addr, pOps[x].pt, &(pOps[x].val), NULL);
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Write a batch of integers into the file of a handle.
+ * 
+ * Every operation is checked against the file limits before anything
+ * is written, so a batch with an error leaves the file untouched.  The
+ * writes are then applied in order, so later writes win where writes
+ * overlap.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle, which must be opened with BINPOKE_READWRITE
+ * 
+ *   pOps - the operations
+ * 
+ *   count - the number of operations, which may be zero
+ * 
+ *   pFail - receives the index of the operation that failed if error,
+ *   or NULL
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_writebatch(
+    BINPOKE *pb,
+    const BINPOKE_OP *pOps,
+    int64_t count,
+    int64_t *pFail,
+    int *perr) {
+  
+  int status = 1;
+  int64_t x = 0;
+  
+  /* Check parameters */
+  if ((pb == NULL) || ((pOps == NULL) && (count > 0)) || (count < 0)) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_PARAM);
+  }
+  
+  /* Check the handle mode */
+  if (status && (!(pb->writable))) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_READONLY);
+  }
+  
+  /* Check that every operation is within the file limits */
+  for(x = 0; status && (x < count); x++) {
+    if (pOps[x].pt == NULL) {
+      status = 0;
+      setError(perr, BINPOKE_ERR_PARAM);
+    } else if (!inRange(pb, pOps[x].addr, pOps[x].pt->width)) {
+      status = 0;
+      setError(perr, BINPOKE_ERR_RANGE);
+    }
+    if ((!status) && (pFail != NULL)) {
+      *pFail = x;
+    }
+  }
+  
+  /* Apply every write in order */
+  if (status) {
+    for(x = 0; x < count; x++) {
+      binpoke_write(pb, pOps[x].addr, pOps[x].pt, pOps[x].val, NULL);
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Parse a 64-bit count parameter from a given string.
+ * 
+ * These strings are unsigned decimal strings that must be in range of
+ * int64_t.  -1 is returned if there is a parsing error.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ * Return:
+ * 
+ *   the unsigned count value, or -1 if parsing error or pstr is NULL
+ */
+int64_t binpoke_parsecount(const char *pstr) {
+  
+  int64_t result = 0;
+  
+  /* Fail if no string or empty string */
+  if (pstr == NULL) {
+    result = -1;
+  } else if (*pstr == 0) {
+    result = -1;
+  }
+  
+  /* Skip any leading zeros */
+  if (result >= 0) {
+    for( ; *pstr == '0'; pstr++);
+  }
+  
+  /* Parse any remaining digits */
+  if (result >= 0) {
+    for( ; *pstr != 0; pstr++) {
+      /* Check that digit is valid */
+      if ((*pstr < '0') || (*pstr > '9')) {
+        result = -1;
+      }
+      
+      /* Multiply result by ten, failing if overflow */
+      if (result >= 0) {
+        if (result <= INT64_MAX / 10) {
+          result *= 10;
+        } else {
+          result = -1;
+        }
+      }
+      
+      /* Add new digit into result, failing if overflow */
+      if (result >= 0) {
+        if (result <= INT64_MAX - (*pstr - '0')) {
+          result += (*pstr - '0');
+        } else {
+          result = -1;
+        }
+      }
+      
+      /* Leave loop if error */
+      if (result < 0) {
+        break;
+      }
+    }
+  }
+  
+  /* Return result or -1 */
+  return result;
+}
+
+/*
+ * Parse a sequence of base-16 digits as an unsigned value.
+ * 
+ * pstr must point to a sequence of at least one base-16 character.
+ * 
+ * The result will be stored in *pv.  If parsing fails, an undefined
+ * value will be in *pv.  Check the return to determine whether parsing
+ * succeeded or not.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ *   pv - pointer to variable to receive parsed result
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error or invalid parameter
+ */
+int binpoke_parsehex(const char *pstr, uint64_t *pv) {
+  
+  int status = 1;
+  int d = 0;
+  
+  /* Check parameters */
+  if ((pstr == NULL) || (pv == NULL)) {
+    status = 0;
+  }
+  
+  /* Reset result to zero */
+  if (status) {
+    *pv = 0;
+  }
+  
+  /* Fail if empty string */
+  if (status && (*pstr == 0)) {
+    status = 0;
+  }
+  
+  /* Parse all digits */
+  if (status) {
+    for( ; *pstr != 0; pstr++) {
+      /* Get current digit value */
+      if ((*pstr >= '0') && (*pstr <= '9')) {
+        d = *pstr - '0';
+      } else if ((*pstr >= 'a') && (*pstr <= 'f')) {
+        d = *pstr - 'a' + 10;
+      } else if ((*pstr >= 'A') && (*pstr <= 'F')) {
+        d = *pstr - 'A' + 10;
+      } else {
+        status = 0;
+      }
+      
+      /* Multiply result by 16, watching for overflow */
+      if (status) {
+        if (*pv <= UINT64_MAX / 16) {
+          *pv *= 16;
+        } else {
+          status = 0;
+        }
+      }
+      
+      /* Add digit into result, watching for overflow */
+      if (status) {
+        if (*pv <= UINT64_MAX - d) {
+          *pv += d;
+        } else {
+          status = 0;
+        }
+      }
+      
+      /* Leave loop if error */
+      if (!status) {
+        break;
+      }
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Parse an address encoded within a given string.
+ * 
+ * If the given string does not begin with "0x" or "0X" then this call
+ * is equivalent to binpoke_parsecount().
+ * 
+ * If the given string begins with "0x" or "0X" then binpoke_parsehex() is
+ * called on the rest of the string after the prefix.  If the unsigned
+ * value returned from that is within 64-bit signed range, then that is
+ * the result; otherwise, the function returns a failure code of -1.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ * Return:
+ * 
+ *   the parsed address, or -1 if parsing error or pstr is NULL
+ */
+int64_t binpoke_parseaddress(const char *pstr) {
+  
+  int64_t result = 0;
+  uint64_t uv = 0;
+  
+  /* Handle cases */
+  if (pstr == NULL) {
+    /* No string to parse */
+    result = -1;
+    
+  } else if (strlen(pstr) < 2) {
+    /* Less than two characters in string, so no possible way there
+     * could be a prefix; call through to binpoke_parsecount() */
+    result = binpoke_parsecount(pstr);
+    
+  } else if ((pstr[0] != '0') ||
+                ((pstr[1] != 'x') && (pstr[1] != 'X'))) {
+    /* Does not begin with a prefix, so call through to binpoke_parsecount() */
+    result = binpoke_parsecount(pstr);
+    
+  } else {
+    /* If we got here, we have a prefix, so parse everything after the
+     * prefix as a hex string */
+    if (binpoke_parsehex(pstr + 2, &uv)) {
+      /* We now have the unsigned 64-bit value; check whether in
+       * range */
+      if (uv <= INT64_MAX) {
+        /* In range, so cast to signed to get result */
+        result = (int64_t) uv;
+        
+      } else {
+        /* Not in range, so parsing failed */
+        result = -1;
+      }
+      
+    } else {
+      /* Parsing failed */
+      result = -1;
+    }
+  }
+  
+  /* Return result or -1 */
+  return result;
+}
+
+/*
+ * Get an integer type by its index in the table of all supported types.
+ * 
+ * Parameters:
+ * 
+ *   i - the index, counting from zero
+ * 
+ * Return:
+ * 
+ *   the type, or NULL if the index is negative or past the end of the
+ *   table
+ */
+const BINPOKE_TYPE *binpoke_type(int i) {
+  
+  const BINPOKE_TYPE *pt = NULL;
+  
+  /* Return the type, or NULL outside the table */
+  if ((i >= 0) && (i < TYPE_COUNT)) {
+    pt = &(typeTable[i]);
+  }
+  return pt;
+}
+
+/*
+ * Parse an integer type name.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ * Return:
+ * 
+ *   the integer type, or NULL if the name is not recognized or pstr is
+ *   NULL
+ */
+const BINPOKE_TYPE *binpoke_parsetype(const char *pstr) {
+  
+  const BINPOKE_TYPE *pt = NULL;
+  
+  /* Look up the type in the table if there is a name */
+  if (pstr != NULL) {
+    for(pt = typeTable; pt->pName != NULL; pt++) {
+      if (strcmp(pstr, pt->pName) == 0) {
+        break;
+      }
+    }
+    if (pt->pName == NULL) {
+      pt = NULL;
+    }
+  }
+  
+  /* Return the type or NULL if not found */
+  return pt;
+}
+
+/*
+ * Parse an integer value to be stored in a given type.
+ * 
+ * See the README for the accepted value formats and the rules for
+ * which formats may be used with which types.
+ * 
+ * The two's-complement bits of the value will be stored in *pv, with
+ * all bits beyond the width of the type clear.  If parsing fails, an
+ * undefined value will be in *pv.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ *   pt - the integer type
+ * 
+ *   pv - pointer to variable to receive parsed result
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if parsing error, value out of range
+ *   for the type, or invalid parameter
+ */
+int binpoke_parsevalue(
+    const char *pstr,
+    const BINPOKE_TYPE *pt,
+    uint64_t *pv) {
+  
+  int status = 1;
+  int neg = 0;
+  int hex = 0;
+  uint64_t mag = 0;
+  uint64_t umax = 0;
+  
+  /* Check parameters */
+  if ((pstr == NULL) || (pt == NULL) || (pv == NULL)) {
+    status = 0;
+  }
+  
+  /* Reset result to zero */
+  if (status) {
+    *pv = 0;
+  }
+  
+  /* Get the maximum unsigned value of the type */
+  if (status) {
+    if (pt->width >= 8) {
+      umax = UINT64_MAX;
+    } else {
+      umax = (UINT64_C(1) << (pt->width * 8)) - 1;
+    }
+  }
+  
+  /* Handle any sign or prefix */
+  if (status) {
+    if (*pstr == '-') {
+      neg = 1;
+      pstr++;
+      
+    } else if (*pstr == '+') {
+      pstr++;
+      
+    } else if ((pstr[0] == '0') &&
+                ((pstr[1] == 'x') || (pstr[1] == 'X'))) {
+      hex = 1;
+      pstr += 2;
+    }
+  }
+  
+  /* Parse the magnitude */
+  if (status) {
+    if (hex) {
+      status = binpoke_parsehex(pstr, &mag);
+    } else {
+      status = parseDecimal(pstr, &mag);
+    }
+  }
+  
+  /* Range-check the magnitude and compute the bits */
+  if (status) {
+    if (hex || (!(pt->sgn))) {
+      /* Unsigned interpretation, so negative values not allowed */
+      if (neg || (mag > umax)) {
+        status = 0;
+      } else {
+        *pv = mag;
+      }
+      
+    } else if (neg) {
+      /* Negative signed value may go one beyond the positive limit */
+      if (mag > (umax >> 1) + 1) {
+        status = 0;
+      } else {
+        *pv = (0 - mag) & umax;
+      }
+      
+    } else {
+      /* Non-negative signed value */
+      if (mag > (umax >> 1)) {
+        status = 0;
+      } else {
+        *pv = mag;
+      }
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Decode the bits of an integer from its component bytes.
+ * 
+ * No sign extension is performed.
+ * 
+ * Parameters:
+ * 
+ *   pBytes - the component bytes of the integer
+ * 
+ *   pt - the integer type
+ * 
+ * Return:
+ * 
+ *   the bits of the integer, or zero if a parameter is NULL
+ */
+uint64_t binpoke_decode(const uint8_t *pBytes, const BINPOKE_TYPE *pt) {
+  
+  int i = 0;
+  uint64_t v = 0;
+  
+  /* Assemble each byte into the result, unless a parameter is NULL */
+  if ((pBytes != NULL) && (pt != NULL)) {
+    for(i = 0; i < pt->width; i++) {
+      if (pt->big) {
+        v = (v << 8) | ((uint64_t) pBytes[i]);
+      } else {
+        v |= (((uint64_t) pBytes[i]) << (i * 8));
+      }
+    }
+  }
+  
+  /* Return result */
+  return v;
+}
+
+/*
+ * Encode the bits of an integer into its component bytes.
+ * 
+ * Bits beyond the width of the type are ignored.
+ * 
+ * Parameters:
+ * 
+ *   pBytes - the buffer to receive the component bytes, which must have
+ *   room for the width of the type
+ * 
+ *   pt - the integer type
+ * 
+ *   v - the bits of the integer
+ */
+void binpoke_encode(uint8_t *pBytes, const BINPOKE_TYPE *pt, uint64_t v) {
+  
+  int i = 0;
+  int s = 0;
+  
+  /* Store each byte, unless a parameter is NULL */
+  if ((pBytes != NULL) && (pt != NULL)) {
+    for(i = 0; i < pt->width; i++) {
+      if (pt->big) {
+        s = (pt->width - 1 - i) * 8;
+      } else {
+        s = i * 8;
+      }
+      pBytes[i] = (uint8_t) ((v >> s) & 0xff);
+    }
+  }
+}
+
+/*
+ * Format one line of a hex listing.
+ * 
+ * The line is the paragraph address, the sixteen byte values in base-16
+ * with an extra gap after the eighth, a bar, and the sixteen bytes as
+ * characters, with anything outside printing US-ASCII shown as a dot.
+ * Only the low 32 bits of the address are shown.  It has no line break.
+ * 
+ * Parameters:
+ * 
+ *   pLine - receives the nul-terminated line, which must have room for
+ *   BINPOKE_LINESIZE characters
+ * 
+ *   addr - the file offset of the first byte in the line, which must be
+ *   a multiple of 16
+ * 
+ *   pValues - the sixteen byte values, each either 0 to 255 or negative
+ *   for a byte that is shown as blank because it is missing
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_formatline(
+    char *pLine,
+    int64_t addr,
+    const int *pValues,
+    int *perr) {
+  
+  int status = 1;
+  int i = 0;
+  int v = 0;
+  char *pc = NULL;
+  uint32_t a = 0;
+  
+  /* Check parameters */
+  if ((pLine == NULL) || (pValues == NULL) || (addr < 0) ||
+      ((addr % 16) != 0)) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_PARAM);
+  }
+  
+  for(i = 0; status && (i < 16); i++) {
+    if (pValues[i] > 255) {
+      status = 0;
+      setError(perr, BINPOKE_ERR_PARAM);
+    }
+  }
+  
+  /* Format the address field */
+  if (status) {
+    pc = pLine;
+    a = (uint32_t) (addr & INT64_C(0xffffffff));
+    for(i = 28; i >= 0; i -= 4) {
+      *pc = hexDigits[(a >> i) & 0xf];
+      pc++;
+    }
+    *pc = ':';
+    pc++;
+  }
+  
+  /* Format each byte value, with three spaces instead of one before
+   * element 8 */
+  for(i = 0; status && (i < 16); i++) {
+    if (i == 8) {
+      memset(pc, ' ', 2);
+      pc += 2;
+    }
+    *pc = ' ';
+    pc++;
+    
+    v = pValues[i];
+    if (v >= 0) {
+      pc[0] = hexDigits[v >> 4];
+      pc[1] = hexDigits[v & 0xf];
+    } else {
+      memset(pc, ' ', 2);
+    }
+    pc += 2;
+  }
+  
+  /* Format the separator and each character */
+  if (status) {
+    memcpy(pc, " | ", 3);
+    pc += 3;
+    
+    for(i = 0; i < 16; i++) {
+      v = pValues[i];
+      if ((v >= 0x20) && (v <= 0x7e)) {
+        *pc = (char) v;
+      } else if (v < 0) {
+        *pc = ' ';
+      } else {
+        *pc = '.';
+      }
+      pc++;
+    }
+    
+    *pc = 0;
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Get the length of a file without opening a handle to it.
+ * 
+ * On POSIX platforms, the length of a regular file is found from its
+ * status.  Other kinds of file, and all files on Windows, are opened
+ * read-only to get their length.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   plen - receives the length in bytes
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_querylen(const char *pPath, int64_t *plen, int *perr) {
+  
+  int status = 1;
+  int found = 0;
+  BINPOKE *pb = NULL;
+#ifndef AKS_WIN
+  struct stat st;
+#endif
+  
+  /* Check parameters */
+  if ((pPath == NULL) || (plen == NULL)) {
+    status = 0;
+    setError(perr, BINPOKE_ERR_PARAM);
+  }
+  
+  /* Get the length of a regular file from its status */
+#ifndef AKS_WIN
+  if (status) {
+    if (stat(pPath, &st) != 0) {
+      status = 0;
+      setError(perr, openError(pPath));
+      
+    } else if (S_ISDIR(st.st_mode)) {
+      status = 0;
+      setError(perr, BINPOKE_ERR_ISDIR);
+      
+    } else if (S_ISREG(st.st_mode)) {
+      *plen = (int64_t) st.st_size;
+      found = 1;
+    }
+  }
+#endif
+  
+  /* Otherwise, open a handle to get the length */
+  if (status && (!found)) {
+    pb = binpoke_open(pPath, BINPOKE_READONLY, perr);
+    if (pb != NULL) {
+      *plen = binpoke_getlen(pb);
+      binpoke_close(pb);
+      pb = NULL;
+    } else {
+      status = 0;
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
+
+/*
+ * Get the length of each of several files.
+ * 
+ * Each file is queried with binpoke_querylen(), and a file that fails
+ * does not stop the others from being queried.
+ * 
+ * Parameters:
+ * 
+ *   ppPath - the paths to the files
+ * 
+ *   count - the number of paths, which may be zero
+ * 
+ *   pLens - receives the length of each file, or -1 for a file that
+ *   failed
+ * 
+ *   pErrs - receives the error code of each file, which is
+ *   BINPOKE_ERR_NONE for a file that succeeded
+ * 
+ * Return:
+ * 
+ *   non-zero if every file was queried, zero if any error or invalid
+ *   parameter
+ */
+int binpoke_query(
+    const char *const *ppPath,
+    int64_t count,
+    int64_t *pLens,
+    int *pErrs) {
+  
+  int status = 1;
+  int64_t x = 0;
+  
+  /* Check parameters */
+  if ((count < 0) || ((count > 0) &&
+        ((ppPath == NULL) || (pLens == NULL) || (pErrs == NULL)))) {
+    status = 0;
+  }
+  
+  /* Query each file in turn, carrying on past any that fail */
+  if (status) {
+    for(x = 0; x < count; x++) {
+      pErrs[x] = BINPOKE_ERR_NONE;
+      if (!binpoke_querylen(ppPath[x], &(pLens[x]), &(pErrs[x]))) {
+        pLens[x] = -1;
+        status = 0;
+      }
+    }
+  }
+  
+  /* Return status */
+  return status;
+}
@@ -0,0 +1,627 @@
+#ifndef LIBBINPOKE_H_INCLUDED
+#define LIBBINPOKE_H_INCLUDED
+
+/*
+ * libbinpoke.h
+ * ============
+ * 
+ * In-process library for the core operations of Binpoke.
+ * 
+ * A file is opened as a handle, and integers and bytes are read and
+ * written through the handle with structured results returned into
+ * caller buffers.  Only binpoke_open() allocates memory.
+ * 
+ * Errors are reported with a status return and an optional error code,
+ * which binpoke_errstr() turns into a message.  This includes invalid
+ * parameters, such as NULL pointers, which are reported as
+ * BINPOKE_ERR_PARAM rather than stopping the program.  Functions that
+ * have no error code report invalid parameters with the same return as
+ * a parsing error.
+ * 
+ * The library only accesses files directly.  Edit sessions, gzip
+ * files, and locks are handled by the binpoke program.
+ * 
+ * See the README.md for further information.
+ */
+
+#include <stdint.h>
+
+/*
+ * Constants
+ * =========
+ */
+
+/*
+ * Modes for opening a handle.
+ * 
+ * BINPOKE_READONLY opens an existing file for reading only.
+ * 
+ * BINPOKE_READWRITE opens an existing file for reading and writing.
+ * 
+ * BINPOKE_CREATE opens a file for reading and writing, creating it with
+ * a length of zero if it does not exist.
+ */
+#define BINPOKE_READONLY  (1)
+#define BINPOKE_READWRITE (2)
+#define BINPOKE_CREATE    (3)
+
+/*
+ * Error codes.
+ * 
+ * BINPOKE_ERR_NONE is never reported as an error, so an error code
+ * variable may be initialized to it.
+ * 
+ * BINPOKE_ERR_RANGE means that an address or byte range is outside the
+ * file limits.
+ * 
+ * BINPOKE_ERR_READONLY means that a handle opened with
+ * BINPOKE_READONLY was asked to modify the file.
+ * 
+ * BINPOKE_ERR_MAXLEN means that a length exceeds the libaksview limit.
+ * 
+ * BINPOKE_ERR_SETLEN means that the file length could not be changed.
+ * 
+ * BINPOKE_ERR_OPEN means that a file could not be opened, for a reason
+ * other than the ones below.
+ * 
+ * BINPOKE_ERR_NOTFOUND means that a file does not exist.
+ * 
+ * BINPOKE_ERR_ISDIR means that a path names a directory.
+ * 
+ * BINPOKE_ERR_PARAM means that a function was called with an invalid
+ * parameter.
+ * 
+ * BINPOKE_ERR_NOMEM means that memory for a handle could not be
+ * allocated.
+ */
+#define BINPOKE_ERR_NONE     (0)
+#define BINPOKE_ERR_RANGE    (1)
+#define BINPOKE_ERR_READONLY (2)
+#define BINPOKE_ERR_MAXLEN   (3)
+#define BINPOKE_ERR_SETLEN   (4)
+#define BINPOKE_ERR_OPEN     (5)
+#define BINPOKE_ERR_NOTFOUND (6)
+#define BINPOKE_ERR_ISDIR    (7)
+#define BINPOKE_ERR_PARAM    (8)
+#define BINPOKE_ERR_NOMEM    (9)
+
+/*
+ * The size of a buffer that receives a formatted listing line from
+ * binpoke_formatline(), including the terminating nul.
+ */
+#define BINPOKE_LINESIZE (79)
+
+/*
+ * Type declarations
+ * =================
+ */
+
+/*
+ * Opaque handle to an open file.
+ */
+struct BINPOKE_TAG;
+typedef struct BINPOKE_TAG BINPOKE;
+
+/*
+ * Structure that describes an integer type.
+ * 
+ * Instances are only obtained from binpoke_type() and
+ * binpoke_parsetype(), and must not be modified.
+ */
+typedef struct {
+  
+  /*
+   * The name of the type, such as "u16le".
+   */
+  const char *pName;
+  
+  /*
+   * Non-zero if the type is signed, zero if unsigned.
+   */
+  int sgn;
+  
+  /*
+   * The number of component bytes in the type.
+   * 
+   * This is either 1, 2, 4, or 8.
+   */
+  int width;
+  
+  /*
+   * Non-zero if the type is big endian, zero if little endian.
+   * 
+   * This is always zero for single-byte types.
+   */
+  int big;
+  
+} BINPOKE_TYPE;
+
+/*
+ * Structure that stores a single integer operation within a batch.
+ */
+typedef struct {
+  
+  /*
+   * The file offset of the first byte of the integer.
+   */
+  int64_t addr;
+  
+  /*
+   * The integer type.
+   */
+  const BINPOKE_TYPE *pt;
+  
+  /*
+   * The bits of the integer value, which a batch read fills in and a
+   * batch write stores.
+   */
+  uint64_t val;
+  
+} BINPOKE_OP;
+
+/*
+ * Public functions
+ * ================
+ */
+
+/*
+ * Open a handle to a file.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   mode - BINPOKE_READONLY, BINPOKE_READWRITE, or BINPOKE_CREATE
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   the new handle, or NULL if error
+ */
+BINPOKE *binpoke_open(const char *pPath, int mode, int *perr);
+
+/*
+ * Close a handle.
+ * 
+ * Any changes are written back to the file.  Does nothing if NULL is
+ * passed.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle to close, or NULL
+ */
+void binpoke_close(BINPOKE *pb);
+
+/*
+ * Get the message for an error code.
+ * 
+ * Parameters:
+ * 
+ *   code - the error code
+ * 
+ * Return:
+ * 
+ *   the error message, which has no line break
+ */
+const char *binpoke_errstr(int code);
+
+/*
+ * Get the current length of the file of a handle.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle
+ * 
+ * Return:
+ * 
+ *   the file length in bytes, or -1 if pb is NULL
+ */
+int64_t binpoke_getlen(BINPOKE *pb);
+
+/*
+ * Change the length of the file of a handle.
+ * 
+ * Bytes added at the end of the file are zero.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle, which must be opened with BINPOKE_READWRITE or
+ *   BINPOKE_CREATE
+ * 
+ *   len - the new length in bytes
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_setlen(BINPOKE *pb, int64_t len, int *perr);
+
+/*
+ * Read an integer from the file of a handle.
+ * 
+ * The bits of the integer are returned without sign extension.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle
+ * 
+ *   addr - the file offset of the first byte of the integer
+ * 
+ *   pt - the integer type
+ * 
+ *   pv - receives the bits of the integer
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_read(
+    BINPOKE *pb,
+    int64_t addr,
+    const BINPOKE_TYPE *pt,
+    uint64_t *pv,
+    int *perr);
+
+/*
+ * Write an integer into the file of a handle.
+ * 
+ * Bits beyond the width of the type are ignored.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle, which must be opened with BINPOKE_READWRITE or
+ *   BINPOKE_CREATE
+ * 
+ *   addr - the file offset of the first byte of the integer
+ * 
+ *   pt - the integer type
+ * 
+ *   v - the bits of the integer
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_write(
+    BINPOKE *pb,
+    int64_t addr,
+    const BINPOKE_TYPE *pt,
+    uint64_t v,
+    int *perr);
+
+/*
+ * Read a range of bytes from the file of a handle.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle
+ * 
+ *   addr - the file offset of the first byte
+ * 
+ *   pBuf - receives the bytes
+ * 
+ *   len - the number of bytes to read, which may be zero
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_readbytes(
+    BINPOKE *pb,
+    int64_t addr,
+    uint8_t *pBuf,
+    int32_t len,
+    int *perr);
+
+/*
+ * Write a range of bytes into the file of a handle.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle, which must be opened with BINPOKE_READWRITE or
+ *   BINPOKE_CREATE
+ * 
+ *   addr - the file offset of the first byte
+ * 
+ *   pBuf - the bytes to write
+ * 
+ *   len - the number of bytes to write, which may be zero
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_writebytes(
+    BINPOKE *pb,
+    int64_t addr,
+    const uint8_t *pBuf,
+    int32_t len,
+    int *perr);
+
+/*
+ * Read a batch of integers from the file of a handle.
+ * 
+ * Every operation is checked against the file limits before anything
+ * is read.  The value of each operation is then filled in.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle
+ * 
+ *   pOps - the operations
+ * 
+ *   count - the number of operations, which may be zero
+ * 
+ *   pFail - receives the index of the operation that failed if error,
+ *   or NULL
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_readbatch(
+    BINPOKE *pb,
+    BINPOKE_OP *pOps,
+    int64_t count,
+    int64_t *pFail,
+    int *perr);
+
+/*
+ * Write a batch of integers into the file of a handle.
+ * 
+ * Every operation is checked against the file limits before anything
+ * is written, so a batch with an error leaves the file untouched.  The
+ * writes are then applied in order, so later writes win where writes
+ * overlap.
+ * 
+ * Parameters:
+ * 
+ *   pb - the handle, which must be opened with BINPOKE_READWRITE or
+ *   BINPOKE_CREATE
+ * 
+ *   pOps - the operations
+ * 
+ *   count - the number of operations, which may be zero
+ * 
+ *   pFail - receives the index of the operation that failed if error,
+ *   or NULL
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_writebatch(
+    BINPOKE *pb,
+    const BINPOKE_OP *pOps,
+    int64_t count,
+    int64_t *pFail,
+    int *perr);
+
+/*
+ * Parse a count, which is an unsigned decimal string in range of
+ * int64_t.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ * Return:
+ * 
+ *   the count, or -1 if parsing error or pstr is NULL
+ */
+int64_t binpoke_parsecount(const char *pstr);
+
+/*
+ * Parse a sequence of base-16 digits with no prefix as an unsigned
+ * value.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ *   pv - receives the value, which is undefined if parsing fails
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if parsing error or invalid parameter
+ */
+int binpoke_parsehex(const char *pstr, uint64_t *pv);
+
+/*
+ * Parse an address, which is either a count or "0x" or "0X" followed by
+ * base-16 digits, in range of int64_t.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ * Return:
+ * 
+ *   the address, or -1 if parsing error or pstr is NULL
+ */
+int64_t binpoke_parseaddress(const char *pstr);
+
+/*
+ * Get an integer type by its index in the table of all supported types.
+ * 
+ * Parameters:
+ * 
+ *   i - the index, counting from zero
+ * 
+ * Return:
+ * 
+ *   the type, or NULL if the index is negative or past the end of the
+ *   table
+ */
+const BINPOKE_TYPE *binpoke_type(int i);
+
+/*
+ * Parse an integer type name.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ * Return:
+ * 
+ *   the integer type, or NULL if the name is not recognized or pstr is
+ *   NULL
+ */
+const BINPOKE_TYPE *binpoke_parsetype(const char *pstr);
+
+/*
+ * Parse an integer value to be stored in a given type.
+ * 
+ * See the README for the accepted value formats and the rules for
+ * which formats may be used with which types.
+ * 
+ * Parameters:
+ * 
+ *   pstr - the string to parse
+ * 
+ *   pt - the integer type
+ * 
+ *   pv - receives the two's-complement bits of the value, with all bits
+ *   beyond the width of the type clear, which are undefined if parsing
+ *   fails
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if parsing error, value out of range
+ *   for the type, or invalid parameter
+ */
+int binpoke_parsevalue(
+    const char *pstr,
+    const BINPOKE_TYPE *pt,
+    uint64_t *pv);
+
+/*
+ * Decode the bits of an integer from its component bytes, without sign
+ * extension.
+ * 
+ * Parameters:
+ * 
+ *   pBytes - the component bytes of the integer
+ * 
+ *   pt - the integer type
+ * 
+ * Return:
+ * 
+ *   the bits of the integer, or zero if a parameter is NULL
+ */
+uint64_t binpoke_decode(const uint8_t *pBytes, const BINPOKE_TYPE *pt);
+
+/*
+ * Encode the bits of an integer into its component bytes.
+ * 
+ * Bits beyond the width of the type are ignored.  Does nothing if a
+ * parameter is NULL.
+ * 
+ * Parameters:
+ * 
+ *   pBytes - receives the component bytes, which must have room for the
+ *   width of the type
+ * 
+ *   pt - the integer type
+ * 
+ *   v - the bits of the integer
+ */
+void binpoke_encode(uint8_t *pBytes, const BINPOKE_TYPE *pt, uint64_t v);
+
+/*
+ * Format one line of a hex listing.
+ * 
+ * The line is the paragraph address, the sixteen byte values in base-16
+ * with an extra gap after the eighth, a bar, and the sixteen bytes as
+ * characters, with anything outside printing US-ASCII shown as a dot.
+ * Only the low 32 bits of the address are shown.  It has no line break.
+ * 
+ * Parameters:
+ * 
+ *   pLine - receives the nul-terminated line, which must have room for
+ *   BINPOKE_LINESIZE characters
+ * 
+ *   addr - the file offset of the first byte in the line, which must be
+ *   a multiple of 16
+ * 
+ *   pValues - the sixteen byte values, each either 0 to 255 or negative
+ *   for a byte that is shown as blank because it is missing
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_formatline(
+    char *pLine,
+    int64_t addr,
+    const int *pValues,
+    int *perr);
+
+/*
+ * Get the length of a file without opening a handle to it.
+ * 
+ * On POSIX platforms, the length of a regular file is found from its
+ * status.  Other kinds of file, and all files on Windows, are opened
+ * read-only to get their length.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path to the file
+ * 
+ *   plen - receives the length in bytes
+ * 
+ *   perr - receives the error code if error, or NULL
+ * 
+ * Return:
+ * 
+ *   non-zero if successful, zero if error
+ */
+int binpoke_querylen(const char *pPath, int64_t *plen, int *perr);
+
+/*
+ * Get the length of each of several files.
+ * 
+ * Each file is queried with binpoke_querylen(), and a file that fails
+ * does not stop the others from being queried.
+ * 
+ * Parameters:
+ * 
+ *   ppPath - the paths to the files
+ * 
+ *   count - the number of paths, which may be zero
+ * 
+ *   pLens - receives the length of each file, or -1 for a file that
+ *   failed
+ * 
+ *   pErrs - receives the error code of each file, which is
+ *   BINPOKE_ERR_NONE for a file that succeeded
+ * 
+ * Return:
+ * 
+ *   non-zero if every file was queried, zero if any error or invalid
+ *   parameter
+ */
+int binpoke_query(
+    const char *const *ppPath,
+    int64_t count,
+    int64_t *pLens,
+    int *pErrs);
+
+#endif